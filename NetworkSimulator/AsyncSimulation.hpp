@@ -2,9 +2,11 @@
 
 #include <iostream>
 
+#include <algorithm>
 #include <random>
-#include <unordered_map>
+#include <vector>
 #include <queue>
+#include <chrono>
 
 #include <boost/graph/adjacency_list.hpp>
 
@@ -15,123 +17,321 @@
 #include <typeinfo>
 
 #include "Node.hpp"
+#include "DynamicGraph.hpp"
+#include "Connectivity.hpp"
 
+// Delay policies decide the arrival time of a message relative to the current time.
+// They are template parameters of AsyncSimulation so the sender lambda contains only the chosen one.
+
+// Synchronous execution, every message arrives in the next cycle
+struct SyncDelay
+{
+    using TimeType = std::uint32_t;
+
+    template <typename RandomEngine>
+    TimeType operator()(RandomEngine &) const
+    {
+        return 1;
+    }
+};
+
+// Asynchronous execution, the delay is drawn from DelayDistribution (at least one cycle)
 template <typename DelayDistribution>
-class AsyncSimulation
+struct AsyncDelay
 {
-public:
     using TimeType = typename DelayDistribution::result_type;
-    using VertexDescriptor = boost::graph_traits<Graph>::vertex_descriptor;
 
-    // AsyncSimulation(Graph &graph, DelayDistribution delay_distribution, std::uint64_t random_seed)
-    //     : _graph{graph}, _delay_distribution{delay_distribution}, _random_engine{random_seed}
-	    AsyncSimulation(Graph &graph, DelayDistribution delay_distribution, std::uint64_t random_seed, bool sync, bool verbose)
-        : _graph{graph}, _delay_distribution{delay_distribution}, _random_engine{random_seed}, _sync{sync}, _verbose{verbose}    
+    DelayDistribution _delay_distribution;
+
+    template <typename RandomEngine>
+    TimeType operator()(RandomEngine &random_engine)
+    {
+        return _delay_distribution(random_engine) + 1;
+    }
+};
+
+// Logging policies are called for every message sent.
+// SilentLogging compiles down to nothing.
+struct SilentLogging
+{
+    template <typename TimeType>
+    static void message_sent(TimeType, TimeType, std::uint32_t, std::uint32_t, const Message &) {}
+};
+
+struct VerboseLogging
+{
+    template <typename TimeType>
+    static void message_sent(TimeType current_time, TimeType arrival_time, std::uint32_t source, std::uint32_t target, const Message &message)
+    {
+        std::cout << "MESSAGE SENDER : " << '\n'
+                  << "    current_time: " << current_time << '\n'
+                  << "    arrival_time: " << arrival_time << '\n'
+                  << "    source : " << source << '\n'
+                  << "    target : " << target << '\n'
+                  << "    message._x : " << message.x << '\n'
+                  << "    message._d : " << message.d << '\n';
+    }
+};
+
+// GraphType can be a boost adjacency_list or any graph type providing the same free functions
+// (vertices, adjacent_vertices, get, prefetchAdjacency), e.g. CsrGraph (CsrGraph.hpp).
+// Its vertex bundle must expose run_logic, _id, _x, _initiator and _incoming_messages,
+// e.g. Node (Node.hpp) or PelegCoroutineNode (CoroutineNode.hpp).
+template <typename DelayPolicy, typename LoggingPolicy = SilentLogging, typename GraphType = Graph>
+class AsyncSimulation
 {
-        auto id_map = boost::get(&Node::_id, _graph);
+public:
+    using TimeType = typename DelayPolicy::TimeType;
+    using VertexDescriptor = typename boost::graph_traits<GraphType>::vertex_descriptor;
+    using NodeType = typename boost::vertex_bundle_type<GraphType>::type;
 
-        auto [begin, end] = boost::vertices(_graph);
+    // Topology changes need the boost-style edge, add_edge and remove_edge,
+    // e.g. DynamicCsrGraph (DynamicGraph.hpp) or an adjacency_list
+    static constexpr bool supports_topology_changes = requires(GraphType &g, VertexDescriptor u) {
+        edge(u, u, g);
+        add_edge(u, u, g);
+        remove_edge(u, u, g);
+    };
+
+    // elide_terminated drops messages at send time when their target has already terminated.
+    // Terminated nodes ignore their mailbox, so this doesn't change the outcome, only the work done.
+    // Dropped messages are counted separately from the delivered ones.
+    // prefetch_distance is the number of upcoming events whose targets are prefetched, 0 disables it.
+    AsyncSimulation(GraphType &graph, DelayPolicy delay_policy, std::uint64_t random_seed, bool elide_terminated = false, std::uint32_t prefetch_distance = 0)
+        : _graph{graph}, _delay_policy{delay_policy}, _random_engine{random_seed}, _elide_terminated{elide_terminated},
+          _prefetch_distance{prefetch_distance}, _staged_events(prefetch_distance)
+    {
+        auto id_map = get(&NodeType::_id, _graph);
+
+        // Node ids are dense, so the per-node bookkeeping is indexed by id rather than hashed
+        _node_map.resize(num_vertices(_graph));
+        auto [begin, end] = vertices(_graph);
         for (auto it = begin; it != end; ++it)
         {
-            _node_map.try_emplace(id_map[*it], *it);
+            if (id_map[*it] >= _node_map.size())
+            {
+                throw std::runtime_error("Node ids must be in [0, number of nodes).");
+            }
+            _node_map[id_map[*it]] = *it;
+        }
+    }
+
+    // Edge insertions and deletions between node ids, applied as events while the simulation runs.
+    // A change at time t is applied before the messages arriving at t. Both endpoints are told through
+    // neighbor_added / neighbor_removed when their node type has them, then run their logic again
+    // since the set of neighbors they wait on has changed. Messages in flight on a deleted edge are dropped.
+    // The nodes cut off from the highest id by a deletion would pulse forever, so run() throws if the
+    // changes applied before a message leave the graph disconnected, which costs O(n + m) per such batch.
+    void schedule_topology_changes(std::vector<TopologyChange<TimeType>> changes)
+    {
+        if constexpr (!supports_topology_changes)
+        {
+            if (!changes.empty())
+            {
+                throw std::runtime_error("This graph type doesn't support topology changes.");
+            }
         }
+
+        std::stable_sort(changes.begin(), changes.end(), [](const auto &a, const auto &b)
+                         { return a._time < b._time; });
+        _topology_changes = std::move(changes);
+        _next_topology_change = 0;
     }
 
     std::uint32_t run()
     {
-        // std::cout << "Verbose is initialized to " << _verbose << std::endl;
-        // std::cout << "Sync is initialized to " << _sync << std::endl;
-		
-		std::unordered_map<std::uint32_t, bool> termination_map{};
+        auto id_map = get(&NodeType::_id, _graph);
 
-        auto id_map = boost::get(&Node::_id, _graph);
+        _termination_map.assign(_node_map.size(), false);
+        _running_nodes = _node_map.size();
 
-        auto [begin, end] = boost::vertices(_graph);
+        auto [begin, end] = vertices(_graph);
         for (auto it = begin; it != end; ++it)
         {
             auto &node = _graph[*it];
-            termination_map.emplace(node._id, false);
             if (node._initiator)
             {
-                auto [adjacent_begin, adjacent_end] = boost::adjacent_vertices(*it, _graph);
+                auto [adjacent_begin, adjacent_end] = adjacent_vertices(*it, _graph);
                 node.run_logic(id_map, adjacent_begin, adjacent_end, make_message_sender(node._id));
             }
         }
 
+        auto start = std::chrono::steady_clock::now();
         do
         {
-            if (_message_queue.empty())
+            if constexpr (supports_topology_changes)
+            {
+                apply_due_topology_changes(id_map);
+            }
+
+            if (_message_queue.empty() && _staged_count == 0)
             {
                 throw std::runtime_error("Event queue is empty but the algorithm hasn't terminated.");
             }
-            MessageWrapper message_wrapper = _message_queue.top();
-            auto target_descriptor = _node_map.at(message_wrapper._target);
-            _message_queue.pop();
-            messageCount += 1;
+            auto [message_wrapper, target_descriptor] = next_event();
             _current_time = message_wrapper._arrival_time;
             // std::cout << "current time updated to:" << message_wrapper._arrival_time << std::endl;
 
-            auto &target_node = _graph[target_descriptor];
-            target_node._incoming_messages.emplace(
+            if constexpr (supports_topology_changes)
+            {
+                // The link the message was sent on has been deleted since
+                if (_edges_removed && !edge(_node_map[message_wrapper._source], target_descriptor, _graph).second)
+                {
+                    ++droppedMessageCount;
+                    continue;
+                }
+            }
+            messageCount += 1;
+
+            _graph[target_descriptor]._incoming_messages.emplace(
                 message_wrapper._source,
                 message_wrapper._message);
 
-            auto [begin, end] = boost::adjacent_vertices(target_descriptor, _graph);
-            termination_map.at(target_node._id) = target_node.run_logic(
-                id_map,
-                begin,
-                end,
-                make_message_sender(target_node._id));
-
-            // nodes use a callable for sending messages so that their logic stays the same
-            // regardless of sync/async simulations and how the delay is decided
-            // run_logic returns true if the node wants to terminate running
-        } while (std::any_of(termination_map.begin(), termination_map.end(), [](const auto &pair)
-                             { return !pair.second; }));
-        std::cout << "Leader elected : " << _graph[*boost::vertices(_graph).first]._x
+            run_node(id_map, target_descriptor);
+        } while (_running_nodes > 0);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Leader elected : " << _graph[*vertices(_graph).first]._x
                   << std::endl
                   << "Termination time : " << _current_time
                   << std::endl
                   << "Message count : " << messageCount
+                  << std::endl
+                  << "Elided messages : " << elidedMessageCount
+                  << std::endl
+                  << "Messages sent : " << messageCount + elidedMessageCount + _message_queue.size() + _staged_count + droppedMessageCount
+                  << std::endl
+                  << "Events per second : " << messageCount / elapsed.count()
                   << std::endl;
-        return _graph[*boost::vertices(_graph).first]._x;
+        if (!_topology_changes.empty())
+        {
+            std::cout << "Topology changes : " << topologyChangeCount
+                      << std::endl
+                      << "Dropped messages : " << droppedMessageCount
+                      << std::endl;
+        }
+        return _graph[*vertices(_graph).first]._x;
     }
 
 private:
-    Graph &_graph;
-    DelayDistribution _delay_distribution;
+    GraphType &_graph;
+    DelayPolicy _delay_policy;
     std::default_random_engine _random_engine;
-	bool _verbose;
-	bool _sync;
+    bool _elide_terminated;
     std::uint64_t messageCount = 0;
+    std::uint64_t elidedMessageCount = 0;
+    std::uint64_t droppedMessageCount = 0;
+    std::uint64_t topologyChangeCount = 0;
+
+    // Runs the logic of the node on its current mailbox and records its termination.
+    // nodes use a callable for sending messages so that their logic stays the same
+    // regardless of sync/async simulations and how the delay is decided
+    // run_logic returns true if the node wants to terminate running
+    template <typename IdMap>
+    void run_node(const IdMap &id_map, VertexDescriptor descriptor)
+    {
+        auto &node = _graph[descriptor];
+        auto [begin, end] = adjacent_vertices(descriptor, _graph);
+        bool terminated = node.run_logic(id_map, begin, end, make_message_sender(node._id));
+
+        // a node never restarts once it has terminated, so counting the first termination is enough
+        if (terminated && !_termination_map[node._id])
+        {
+            _termination_map[node._id] = true;
+            --_running_nodes;
+        }
+    }
+
+    // Applies the changes due before the next message, and the next change if no message is left.
+    // Staged events all arrive at the current time, which is before any change not applied yet.
+    // The graph is only checked after the whole batch, so an edge can be deleted and replaced at the same time.
+    template <typename IdMap>
+    void apply_due_topology_changes(const IdMap &id_map)
+    {
+        bool any_deletion = false;
+        while (_next_topology_change < _topology_changes.size() && _staged_count == 0 &&
+               (_message_queue.empty() || _topology_changes[_next_topology_change]._time <= _message_queue.top()._arrival_time))
+        {
+            const auto &change = _topology_changes[_next_topology_change++];
+            any_deletion |= !change._insert;
+            apply_topology_change(id_map, change);
+        }
+
+        if (any_deletion && !isConnected(_graph))
+        {
+            throw std::runtime_error("The topology changes at time " + std::to_string(_current_time) + " disconnect the graph, so the election can't terminate.");
+        }
+    }
+
+    template <typename IdMap>
+    void apply_topology_change(const IdMap &id_map, const TopologyChange<TimeType> &change)
+    {
+        if (change._u >= _node_map.size() || change._v >= _node_map.size())
+        {
+            throw std::runtime_error("Topology change between unknown nodes.");
+        }
+
+        VertexDescriptor u = _node_map[change._u];
+        VertexDescriptor v = _node_map[change._v];
+        if (change._u == change._v || edge(u, v, _graph).second == change._insert)
+        {
+            return;
+        }
+
+        if (change._insert)
+        {
+            add_edge(u, v, _graph);
+        }
+        else
+        {
+            remove_edge(u, v, _graph);
+            _edges_removed = true;
+        }
+        ++topologyChangeCount;
+        _current_time = std::max(_current_time, change._time);
+
+        for (auto [descriptor, neighbor_id] : {std::pair{u, change._v}, std::pair{v, change._u}})
+        {
+            // A terminated node still gets the hooks, so a new neighbor learns about the completion
+            auto &node = _graph[descriptor];
+            if constexpr (requires { node.neighbor_added(neighbor_id, make_message_sender(node._id)); node.neighbor_removed(neighbor_id); })
+            {
+                if (change._insert)
+                {
+                    node.neighbor_added(neighbor_id, make_message_sender(node._id));
+                }
+                else
+                {
+                    node.neighbor_removed(neighbor_id);
+                }
+            }
+            if (!_termination_map[node._id])
+            {
+                run_node(id_map, descriptor);
+            }
+        }
+    }
 
     auto make_message_sender(std::uint32_t source)
     {
         return [this, source](std::uint32_t target, const Message &message)
         {
-			std::uint32_t arrival_time;
-			if (_sync == true)
-				arrival_time = _current_time + 1;
-			else
-            	arrival_time = _current_time + _delay_distribution(_random_engine) + 1;
-            
-			MessageWrapper message_wrapper{
+            if (_elide_terminated && _termination_map[target])
+            {
+                ++elidedMessageCount;
+                return;
+            }
+
+            TimeType arrival_time = _current_time + _delay_policy(_random_engine);
+
+            MessageWrapper message_wrapper{
                 arrival_time,
                 source,
                 target,
                 message};
             _message_queue.emplace(message_wrapper);
 
-			if (_verbose == true)
-			{
-				std::cout << "MESSAGE SENDER : " << std::endl;
-	            std::cout << "    current_time: " << _current_time << std::endl;
-	            std::cout << "    arrival_time: " << arrival_time << std::endl;
-	            std::cout << "    source : " << source << std::endl;
-	            std::cout << "    target : " << target << std::endl;
-	            std::cout << "    message._x : " << message.x << std::endl;
-	            std::cout << "    message._d : " << message.d << std::endl;
-			}
+            LoggingPolicy::message_sent(_current_time, arrival_time, source, target, message);
         };
     }
 
@@ -148,7 +348,55 @@ private:
         }
     };
 
+    struct StagedEvent
+    {
+        MessageWrapper _message_wrapper;
+        VertexDescriptor _target_descriptor;
+    };
+
+    // Pops the next event, then drains up to _prefetch_distance more events into the staging ring
+    // and prefetches their targets so the memory is in cache by the time they are processed.
+    // Only events with the same arrival time are staged: every message sent while processing
+    // arrives at least one cycle later, so the staged events are still the next ones in time order.
+    StagedEvent next_event()
+    {
+        StagedEvent event;
+        if (_staged_count > 0)
+        {
+            event = _staged_events[_staged_head];
+            _staged_head = (_staged_head + 1) % _prefetch_distance;
+            --_staged_count;
+        }
+        else
+        {
+            event = StagedEvent{_message_queue.top(), _node_map[_message_queue.top()._target]};
+            _message_queue.pop();
+        }
+
+        while (_staged_count < _prefetch_distance && !_message_queue.empty() && _message_queue.top()._arrival_time == event._message_wrapper._arrival_time)
+        {
+            auto target_descriptor = _node_map[_message_queue.top()._target];
+            prefetch(&_graph[target_descriptor]);
+            prefetchAdjacency(target_descriptor, _graph);
+
+            _staged_events[(_staged_head + _staged_count) % _prefetch_distance] = StagedEvent{_message_queue.top(), target_descriptor};
+            ++_staged_count;
+            _message_queue.pop();
+        }
+
+        return event;
+    }
+
     TimeType _current_time{0};
-    std::unordered_map<std::uint32_t, VertexDescriptor> _node_map{};
+    std::vector<VertexDescriptor> _node_map{};
+    std::vector<bool> _termination_map{};
+    std::uint64_t _running_nodes = 0;
+    std::uint32_t _prefetch_distance;
+    std::vector<StagedEvent> _staged_events;
+    std::uint32_t _staged_head = 0;
+    std::uint32_t _staged_count = 0;
     std::priority_queue<MessageWrapper, std::vector<MessageWrapper>, std::greater<MessageWrapper>> _message_queue{};
+    std::vector<TopologyChange<TimeType>> _topology_changes{};
+    std::size_t _next_topology_change = 0;
+    bool _edges_removed = false;
 };
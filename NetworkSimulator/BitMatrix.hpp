@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include "Parallel.hpp"
+
+// Square boolean matrix stored one bit per entry, 64 entries per word. Every row is padded to a
+// multiple of 4 words (256 columns) with zero bits, so that the row loops below always work on whole
+// groups of 4 words, which the compiler turns into vector instructions.
+class BitMatrix
+{
+public:
+    static constexpr std::uint64_t words_per_group = 4;
+
+    explicit BitMatrix(std::uint32_t size = 0)
+        : _size{size}, _words_per_row{(static_cast<std::uint64_t>(size) + 64 * words_per_group - 1) / (64 * words_per_group) * words_per_group},
+          _words(_words_per_row * size, 0)
+    {
+    }
+
+    static BitMatrix identity(std::uint32_t size)
+    {
+        BitMatrix matrix{size};
+        for (std::uint32_t i = 0; i < size; ++i)
+        {
+            matrix.set(i, i);
+        }
+        return matrix;
+    }
+
+    std::uint32_t size() const { return _size; }
+    std::uint64_t words_per_row() const { return _words_per_row; }
+    std::uint64_t bytes() const { return _words.size() * sizeof(std::uint64_t); }
+
+    bool get(std::uint32_t row, std::uint32_t column) const { return (_words[row * _words_per_row + column / 64] >> (column % 64)) & 1; }
+    void set(std::uint32_t row, std::uint32_t column) { _words[row * _words_per_row + column / 64] |= std::uint64_t{1} << (column % 64); }
+
+    std::uint64_t *row(std::uint32_t i) { return _words.data() + i * _words_per_row; }
+    const std::uint64_t *row(std::uint32_t i) const { return _words.data() + i * _words_per_row; }
+
+    // Whether every entry is set
+    bool all() const
+    {
+        const std::uint64_t full_words = _size / 64;
+        const std::uint64_t last_word = _size % 64 == 0 ? 0 : (std::uint64_t{1} << (_size % 64)) - 1;
+        for (std::uint32_t i = 0; i < _size; ++i)
+        {
+            const std::uint64_t *words = row(i);
+            if (!std::all_of(words, words + full_words, [](std::uint64_t word)
+                             { return word == ~std::uint64_t{0}; }) ||
+                (last_word != 0 && words[full_words] != last_word))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator==(const BitMatrix &other) const = default;
+
+private:
+    std::uint32_t _size;
+    std::uint64_t _words_per_row;
+    std::vector<std::uint64_t> _words;
+};
+
+// Boolean product: row i of the result is the OR of the rows k of b for which a(i, k) is set, so a
+// sparse row of a costs little. The rows of b are taken in blocks that fit in the L2 cache, and every
+// row of the result goes over one block before the next. A row that is already all 1s skips the
+// remaining blocks, which is most of them when squaring the reachability matrix of a dense graph.
+// Rows are split between num_threads threads. O(n^3 / 64) word operations at worst.
+inline BitMatrix multiply(const BitMatrix &a, const BitMatrix &b, std::uint32_t num_threads = 0)
+{
+    constexpr std::uint64_t l2_bytes = 256 * 1024;
+    const std::uint32_t n = a.size();
+    const std::uint64_t words_per_row = a.words_per_row();
+    const std::uint64_t group = BitMatrix::words_per_group;
+    // Words of a row of a, 64 rows of b each
+    const std::uint64_t block_words = std::max<std::uint64_t>(1, l2_bytes / (64 * std::max<std::uint64_t>(b.bytes() / std::max<std::uint32_t>(n, 1), 1)));
+    const std::uint64_t full_words = n / 64;
+    const std::uint64_t last_word = n % 64 == 0 ? 0 : (std::uint64_t{1} << (n % 64)) - 1;
+
+    BitMatrix product{n};
+    parallelFor(0, n, num_threads, [&](std::uint32_t, std::uint64_t first_row, std::uint64_t last_row)
+                {
+                    std::vector<char> full(last_row - first_row, false);
+                    for (std::uint64_t block = 0; block < words_per_row; block += block_words)
+                    {
+                        const std::uint64_t block_end = std::min(block + block_words, words_per_row);
+                        for (std::uint64_t i = first_row; i < last_row; ++i)
+                        {
+                            if (full[i - first_row])
+                            {
+                                continue;
+                            }
+                            const std::uint64_t *a_row = a.row(i);
+                            std::uint64_t *out = product.row(i);
+                            for (std::uint64_t word = block; word < block_end; ++word)
+                            {
+                                for (std::uint64_t bits = a_row[word]; bits != 0; bits &= bits - 1)
+                                {
+                                    const std::uint64_t *b_row = b.row(64 * word + std::countr_zero(bits));
+                                    for (std::uint64_t w = 0; w < words_per_row; w += group)
+                                    {
+                                        // All loads before the stores, so the group compiles to vector ORs even if out could alias b
+                                        const std::uint64_t o0 = out[w] | b_row[w], o1 = out[w + 1] | b_row[w + 1];
+                                        const std::uint64_t o2 = out[w + 2] | b_row[w + 2], o3 = out[w + 3] | b_row[w + 3];
+                                        out[w] = o0;
+                                        out[w + 1] = o1;
+                                        out[w + 2] = o2;
+                                        out[w + 3] = o3;
+                                    }
+                                }
+                            }
+                            full[i - first_row] = std::all_of(out, out + full_words, [](std::uint64_t w)
+                                                              { return w == ~std::uint64_t{0}; }) &&
+                                                  (last_word == 0 || out[full_words] == last_word);
+                        }
+                    } });
+    return product;
+}
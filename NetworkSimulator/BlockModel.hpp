@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+#include "GraphGen.hpp"
+#include "RandomStreams.hpp"
+
+// Stochastic block model: nodes are split into blocks of the given sizes, and two nodes of blocks
+// i and j are linked with probability _probabilities[i * k + j], for k blocks. The matrix must be symmetric.
+struct BlockModel
+{
+    std::vector<std::uint32_t> _block_sizes;
+    std::vector<double> _probabilities;
+
+    std::uint32_t num_blocks() const { return _block_sizes.size(); }
+    double probability(std::uint32_t i, std::uint32_t j) const { return _probabilities[i * _block_sizes.size() + j]; }
+
+    // k blocks of (almost) equal size, with probability p inside a block and q between blocks
+    static BlockModel planted(std::uint32_t num_nodes, std::uint32_t num_blocks, double p, double q)
+    {
+        if (num_blocks == 0)
+        {
+            throw std::runtime_error("A block model needs at least one block.");
+        }
+        BlockModel model;
+        for (std::uint32_t i = 0; i < num_blocks; ++i)
+        {
+            model._block_sizes.push_back(num_nodes / num_blocks + (i < num_nodes % num_blocks));
+            for (std::uint32_t j = 0; j < num_blocks; ++j)
+            {
+                model._probabilities.push_back(i == j ? p : q);
+            }
+        }
+        return model;
+    }
+};
+
+// Block model graph and the block of each node. Blocks are contiguous ranges of node ids, in order.
+template <typename NodeType>
+struct BlockGraph
+{
+    CsrGraph<NodeType> _graph;
+    std::vector<std::uint32_t> _blocks;
+};
+
+// Calls body(row, column) for the pairs of rows [first_row, last_row) x columns [0, num_columns) that
+// get an edge with probability edge_probability, in row-major order, jumping over the pairs without
+// an edge as forEachRandomEdgeInRows does.
+template <typename RandomEngine, typename Body>
+void forEachRandomBipartiteEdge(std::uint32_t first_row, std::uint32_t last_row, std::uint32_t num_columns, double edge_probability, RandomEngine &random_gen, const Body &body)
+{
+    if (!(edge_probability > 0.0) || num_columns == 0)
+    {
+        return;
+    }
+    if (edge_probability >= 1.0)
+    {
+        for (std::uint32_t row = first_row; row < last_row; ++row)
+        {
+            for (std::uint32_t column = 0; column < num_columns; ++column)
+            {
+                body(row, column);
+            }
+        }
+        return;
+    }
+
+    const double log_q = std::log1p(-edge_probability);
+    const std::uint64_t end = static_cast<std::uint64_t>(last_row - first_row) * num_columns;
+    for (std::uint64_t pair = geometricSkip(random_gen, log_q); pair < end; pair += 1 + geometricSkip(random_gen, log_q))
+    {
+        body(first_row + static_cast<std::uint32_t>(pair / num_columns), static_cast<std::uint32_t>(pair % num_columns));
+    }
+}
+
+// Samples a stochastic block model in O(n + m). Every block pair is cut into chunks of rows holding
+// about the same number of pairs, and each chunk skips geometrically over its pairs with its own random
+// stream, so chunks of all block pairs run in parallel and the graph only depends on the seed.
+template <typename NodeType = Node>
+BlockGraph<NodeType> generateBlockModelCsrGraph(const BlockModel &model, std::uint64_t seed, std::uint32_t num_threads = 0)
+{
+    const std::uint32_t k = model.num_blocks();
+    if (model._probabilities.size() != static_cast<std::uint64_t>(k) * k)
+    {
+        throw std::runtime_error("The block model needs one probability per pair of blocks.");
+    }
+
+    std::vector<std::uint32_t> block_starts{0};
+    for (std::uint32_t size : model._block_sizes)
+    {
+        if (static_cast<std::uint64_t>(block_starts.back()) + size > std::numeric_limits<std::uint32_t>::max())
+        {
+            throw std::runtime_error("Too many nodes in the block model.");
+        }
+        block_starts.push_back(block_starts.back() + size);
+    }
+    const std::uint32_t num_nodes = block_starts.back();
+
+    // Rows [first_row, last_row) of block pair (i, j), i <= j. Within a block, row v holds the pairs (u, v) with u < v.
+    struct Chunk
+    {
+        std::uint32_t _i, _j, _first_row, _last_row;
+    };
+    std::vector<Chunk> chunks;
+    for (std::uint32_t i = 0; i < k; ++i)
+    {
+        for (std::uint32_t j = i; j < k; ++j)
+        {
+            const std::uint32_t rows = model._block_sizes[i];
+            if (model.probability(i, j) != model.probability(j, i))
+            {
+                throw std::runtime_error("The block model probabilities must be symmetric.");
+            }
+            const double p = std::clamp(model.probability(i, j), 0.0, 1.0);
+            const std::uint64_t num_pairs = i == j ? static_cast<std::uint64_t>(rows) * (rows > 0 ? rows - 1 : 0) / 2 : static_cast<std::uint64_t>(rows) * model._block_sizes[j];
+            if (num_pairs == 0 || p == 0.0)
+            {
+                continue;
+            }
+            const std::uint64_t pieces = std::clamp<std::uint64_t>(static_cast<std::uint64_t>(num_pairs * p / (1 << 20)) + rows / generation_chunk_size, 1, rows);
+            for (std::uint64_t piece = 0; piece < pieces; ++piece)
+            {
+                auto row_at = [&](std::uint64_t boundary) -> std::uint32_t
+                {
+                    if (boundary == pieces)
+                    {
+                        return rows;
+                    }
+                    if (i == j)
+                    {
+                        return boundary == 0 ? 1 : nodePairAt(num_pairs / pieces * boundary).second;
+                    }
+                    return rows * boundary / pieces;
+                };
+                chunks.push_back(Chunk{i, j, row_at(piece), row_at(piece + 1)});
+            }
+        }
+    }
+
+    CsrGraph<NodeType> graph = generateCsrGraphInChunks<NodeType>(num_nodes, chunks.size(), num_threads, [&](std::uint64_t index, auto &edges)
+                                                                  {
+                                                                      const Chunk &chunk = chunks[index];
+                                                                      SplitMix64 random_gen{streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Edges), index)};
+                                                                      const std::uint32_t row_start = block_starts[chunk._i];
+                                                                      const std::uint32_t column_start = block_starts[chunk._j];
+                                                                      const double p = model.probability(chunk._i, chunk._j);
+                                                                      if (chunk._i == chunk._j)
+                                                                      {
+                                                                          forEachRandomEdgeInRows(chunk._first_row, chunk._last_row, p, random_gen, [&](std::uint32_t u, std::uint32_t v)
+                                                                                                  { edges.emplace_back(row_start + u, row_start + v); });
+                                                                      }
+                                                                      else
+                                                                      {
+                                                                          forEachRandomBipartiteEdge(chunk._first_row, chunk._last_row, model._block_sizes[chunk._j], p, random_gen, [&](std::uint32_t row, std::uint32_t column)
+                                                                                                     { edges.emplace_back(row_start + row, column_start + column); });
+                                                                      }
+                                                                  });
+
+    std::vector<std::uint32_t> blocks(num_nodes);
+    for (std::uint32_t i = 0; i < k; ++i)
+    {
+        std::fill(blocks.begin() + block_starts[i], blocks.begin() + block_starts[i + 1], i);
+    }
+    return BlockGraph<NodeType>{std::move(graph), std::move(blocks)};
+}
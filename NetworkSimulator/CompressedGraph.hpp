@@ -0,0 +1,315 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+
+// Undirected graph with compressed neighbor lists, for topologies too large for CsrGraph.
+// Each sorted neighbor list is stored in one of two formats, whichever is smaller:
+//  - gaps: the first neighbor as a zigzag-encoded difference from v, then the differences
+//    between consecutive neighbors minus one, as LEB128 varints (1 byte for gaps below 128)
+//  - bitmap: one bit per vertex, for vertices adjacent to most of the graph
+// Neighbors are decoded on the fly by the adjacency iterator.
+template <typename NodeType = Node>
+class CompressedGraph
+{
+public:
+    class AdjacencyIterator;
+
+    using vertex_descriptor = std::uint32_t;
+    using edge_descriptor = std::pair<std::uint32_t, std::uint32_t>;
+    using adjacency_iterator = AdjacencyIterator;
+    using vertex_iterator = boost::counting_iterator<std::uint32_t>;
+    using directed_category = boost::undirected_tag;
+    using edge_parallel_category = boost::disallow_parallel_edge_tag;
+    using traversal_category = AdjacencyTraversalTag;
+    using vertices_size_type = std::uint32_t;
+    using edges_size_type = std::uint64_t;
+    using degree_size_type = std::uint32_t;
+    using vertex_bundled = NodeType;
+
+    // Forward iterator decoding one neighbor list
+    class AdjacencyIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::uint32_t *;
+        using reference = std::uint32_t;
+
+        AdjacencyIterator() = default;
+
+        AdjacencyIterator(const std::uint8_t *data, std::uint32_t remaining, std::uint32_t v, bool bitmap)
+            : _data{data}, _remaining{remaining}, _bitmap{bitmap}
+        {
+            if (_remaining == 0)
+            {
+                return;
+            }
+
+            if (_bitmap)
+            {
+                _word = load_word(0);
+                advance_bitmap();
+            }
+            else
+            {
+                std::uint64_t zigzag = read_varint();
+                std::int64_t difference = static_cast<std::int64_t>(zigzag >> 1) ^ -static_cast<std::int64_t>(zigzag & 1);
+                _current = static_cast<std::uint32_t>(static_cast<std::int64_t>(v) + difference);
+            }
+        }
+
+        std::uint32_t operator*() const { return _current; }
+
+        AdjacencyIterator &operator++()
+        {
+            if (--_remaining == 0)
+            {
+                return *this;
+            }
+
+            if (_bitmap)
+            {
+                advance_bitmap();
+            }
+            else
+            {
+                _current += static_cast<std::uint32_t>(read_varint()) + 1;
+            }
+            return *this;
+        }
+
+        AdjacencyIterator operator++(int)
+        {
+            AdjacencyIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const AdjacencyIterator &other) const { return _remaining == other._remaining; }
+        bool operator!=(const AdjacencyIterator &other) const { return _remaining != other._remaining; }
+
+    private:
+        std::uint64_t read_varint()
+        {
+            std::uint64_t value = *_data & 0x7f;
+            std::uint32_t shift = 7;
+            while (*_data++ & 0x80)
+            {
+                value |= static_cast<std::uint64_t>(*_data & 0x7f) << shift;
+                shift += 7;
+            }
+            return value;
+        }
+
+        std::uint64_t load_word(std::uint32_t index) const
+        {
+            std::uint64_t word;
+            std::memcpy(&word, _data + 8 * index, sizeof(word));
+            return word;
+        }
+
+        // Moves to the next set bit, _word holds the bits of the current word not visited yet
+        void advance_bitmap()
+        {
+            while (_word == 0)
+            {
+                _word = load_word(++_word_index);
+            }
+            _current = _word_index * 64 + std::countr_zero(_word);
+            _word &= _word - 1;
+        }
+
+        const std::uint8_t *_data = nullptr;
+        std::uint32_t _remaining = 0;
+        std::uint32_t _current = 0;
+        bool _bitmap = false;
+        std::uint32_t _word_index = 0;
+        std::uint64_t _word = 0;
+    };
+
+    CompressedGraph() = default;
+
+    // Compresses any graph with vertex indices in [0, num_vertices), e.g. Graph or CsrGraph.
+    // Node states are copied as they are.
+    template <typename SourceGraph>
+    explicit CompressedGraph(const SourceGraph &g)
+    {
+        // The member functions would hide the free ones, which are found through the source graph type
+        using boost::adjacent_vertices;
+        using boost::num_vertices;
+
+        const std::uint32_t n = num_vertices(g);
+        const std::uint64_t bitmap_bytes = (static_cast<std::uint64_t>(n) + 63) / 64 * 8;
+
+        _offsets.reserve(n + 1);
+        _degrees.reserve(n);
+        _nodes.reserve(n);
+
+        std::vector<std::uint32_t> neighbors;
+        std::vector<std::uint8_t> encoded;
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            auto [begin, end] = adjacent_vertices(v, g);
+            neighbors.assign(begin, end);
+            std::sort(neighbors.begin(), neighbors.end());
+
+            encoded.clear();
+            encode_gaps(v, neighbors, encoded);
+
+            if (encoded.size() > bitmap_bytes)
+            {
+                // Bitmaps are read a word at a time, keep them 8-byte aligned
+                _data.resize((_data.size() + 7) / 8 * 8, 0);
+                _offsets.push_back(_data.size() | bitmap_flag);
+                _data.resize(_data.size() + bitmap_bytes, 0);
+                std::uint8_t *bitmap = _data.data() + (_offsets.back() & ~bitmap_flag);
+                for (std::uint32_t neighbor : neighbors)
+                {
+                    bitmap[neighbor / 8] |= std::uint8_t{1} << (neighbor % 8);
+                }
+            }
+            else
+            {
+                _offsets.push_back(_data.size());
+                _data.insert(_data.end(), encoded.begin(), encoded.end());
+            }
+
+            _degrees.push_back(neighbors.size());
+            _num_edges += neighbors.size();
+            _nodes.push_back(g[v]);
+        }
+        _offsets.push_back(_data.size());
+        _num_edges /= 2;
+
+        // Padding so that the varint reader and the bitmap reader never read past the end
+        _data.resize(_data.size() + 8, 0);
+        _data.shrink_to_fit();
+    }
+
+    std::uint32_t num_vertices() const { return _nodes.size(); }
+    std::uint64_t num_edges() const { return _num_edges; }
+    std::uint32_t degree(std::uint32_t v) const { return _degrees[v]; }
+
+    std::pair<adjacency_iterator, adjacency_iterator> adjacency(std::uint32_t v) const
+    {
+        const bool bitmap = (_offsets[v] & bitmap_flag) != 0;
+        const std::uint8_t *data = encoded_row(v);
+        return {AdjacencyIterator{data, _degrees[v], v, bitmap}, AdjacencyIterator{data, 0, v, bitmap}};
+    }
+
+    // First byte of the encoded neighbor list of v
+    const std::uint8_t *encoded_row(std::uint32_t v) const
+    {
+        return _data.data() + (_offsets[v] & ~bitmap_flag);
+    }
+
+    NodeType &operator[](std::uint32_t v) { return _nodes[v]; }
+    const NodeType &operator[](std::uint32_t v) const { return _nodes[v]; }
+    const NodeType *node_data() const { return _nodes.data(); }
+
+    // Bits of encoded neighbor lists per directed edge
+    double bits_per_edge() const
+    {
+        return _num_edges == 0 ? 0.0 : 8.0 * _data.size() / (2.0 * _num_edges);
+    }
+
+    // Bits per directed edge including the offsets and degrees
+    double total_bits_per_edge() const
+    {
+        return _num_edges == 0 ? 0.0 : 8.0 * topology_bytes() / (2.0 * _num_edges);
+    }
+
+    std::uint64_t topology_bytes() const
+    {
+        return _data.capacity() + _offsets.capacity() * sizeof(std::uint64_t) + _degrees.capacity() * sizeof(std::uint32_t);
+    }
+
+private:
+    static constexpr std::uint64_t bitmap_flag = std::uint64_t{1} << 63;
+
+    static void write_varint(std::uint64_t value, std::vector<std::uint8_t> &out)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<std::uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    static void encode_gaps(std::uint32_t v, const std::vector<std::uint32_t> &neighbors, std::vector<std::uint8_t> &out)
+    {
+        if (neighbors.empty())
+        {
+            return;
+        }
+
+        std::int64_t difference = static_cast<std::int64_t>(neighbors[0]) - v;
+        write_varint((static_cast<std::uint64_t>(difference) << 1) ^ static_cast<std::uint64_t>(difference >> 63), out);
+        for (std::size_t i = 1; i < neighbors.size(); ++i)
+        {
+            write_varint(neighbors[i] - neighbors[i - 1] - 1, out);
+        }
+    }
+
+    std::vector<std::uint64_t> _offsets{};
+    std::vector<std::uint32_t> _degrees{};
+    std::vector<std::uint8_t> _data{};
+    std::uint64_t _num_edges = 0;
+    std::vector<NodeType> _nodes{};
+};
+
+template <typename NodeType>
+std::pair<boost::counting_iterator<std::uint32_t>, boost::counting_iterator<std::uint32_t>> vertices(const CompressedGraph<NodeType> &g)
+{
+    return {0, g.num_vertices()};
+}
+
+template <typename NodeType>
+std::uint32_t num_vertices(const CompressedGraph<NodeType> &g)
+{
+    return g.num_vertices();
+}
+
+template <typename NodeType>
+std::uint64_t num_edges(const CompressedGraph<NodeType> &g)
+{
+    return g.num_edges();
+}
+
+template <typename NodeType>
+auto adjacent_vertices(std::uint32_t v, const CompressedGraph<NodeType> &g)
+{
+    return g.adjacency(v);
+}
+
+template <typename NodeType>
+std::uint32_t out_degree(std::uint32_t v, const CompressedGraph<NodeType> &g)
+{
+    return g.degree(v);
+}
+
+template <typename NodeType, typename Member, typename T>
+NodeMemberMap<NodeType, T> get(T Member::*member, const CompressedGraph<NodeType> &g)
+{
+    return {g.node_data(), member};
+}
+
+template <typename NodeType>
+void prefetchAdjacency(std::uint32_t v, const CompressedGraph<NodeType> &g)
+{
+    prefetch(g.encoded_row(v));
+}
@@ -0,0 +1,111 @@
+#include "CompressedGraph.hpp"
+#include "AsyncSimulation.hpp"
+#include "CoroutineNode.hpp"
+
+#include "GraphGen.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Just the node fields the graphs set, so that graphs with millions of vertices stay small
+struct IdNode {
+    std::uint32_t _id = 0;
+    std::uint32_t _x = 0;
+};
+
+template <typename NodeType>
+void expectSameAdjacency(const CompressedGraph<NodeType> &compressed, const CsrGraph<NodeType> &csr) {
+    ASSERT_EQ(compressed.num_vertices(), csr.num_vertices());
+    ASSERT_EQ(compressed.num_edges(), csr.num_edges());
+    for (std::uint32_t v = 0; v < csr.num_vertices(); ++v) {
+        auto [begin, end] = compressed.adjacency(v);
+        auto [csr_begin, csr_end] = csr.adjacency(v);
+        ASSERT_EQ(compressed.degree(v), csr.degree(v)) << "vertex " << v;
+        ASSERT_TRUE(std::equal(begin, end, csr_begin, csr_end)) << "vertex " << v;
+        ASSERT_EQ(compressed[v]._id, csr[v]._id);
+    }
+}
+
+}
+
+// Gaps of 2^7 - 1, 2^7, 2^14 - 1, 2^14, 2^21 - 1 and 2^21 sit on both sides of every varint length
+// up to 4 bytes, and first neighbors 64 above or 64 and 65 below v on both sides of 2 byte zigzags
+TEST(CompressedGraphTest, RoundTripsGapsAtVarintBoundaries) {
+    const std::uint32_t n = (1 << 21) + 16;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    std::uint32_t neighbor = 1;
+    for (std::uint32_t gap : {127u, 128u, 16383u, 16384u}) {
+        edges.emplace_back(0, neighbor);
+        neighbor += gap + 1;
+    }
+    edges.emplace_back(0, neighbor);
+    edges.emplace_back(3, 4);
+    edges.emplace_back(3, 4 + (1 << 21));
+    edges.emplace_back(5, 6);
+    edges.emplace_back(5, 7 + (1 << 21));
+    edges.emplace_back(1000, 1064);
+    edges.emplace_back(2000, 1936);
+    edges.emplace_back(3000, 2935);
+    CsrGraph<IdNode> csr{n, edges};
+    expectSameAdjacency(CompressedGraph<IdNode>{csr}, csr);
+}
+
+// Vertex 0 and the last vertex are adjacent to nearly every vertex, so their rows are bitmaps, the last one
+// ending in a partial word at the end of the data. Vertices 5 and 6 have no neighbors.
+TEST(CompressedGraphTest, RoundTripsBitmapAndEmptyRows) {
+    const std::uint32_t n = 200;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    for (std::uint32_t v = 1; v < n; ++v) {
+        if (v != 5 && v != 6) {
+            edges.emplace_back(0, v);
+            if (v < n - 1) {
+                edges.emplace_back(v, n - 1);
+            }
+        }
+    }
+    edges.emplace_back(150, 3);
+    CsrGraph<> csr{n, edges};
+    CompressedGraph<> compressed{csr};
+    expectSameAdjacency(compressed, csr);
+    ASSERT_EQ(compressed.degree(5), 0);
+    // A bitmap takes n / 8 bytes rounded up to a word, the gaps would take one byte per neighbor
+    ASSERT_EQ(compressed.encoded_row(1) - compressed.encoded_row(0), 32);
+}
+
+// Rows are decoded in the same order CsrGraph stores them, so the same seed gives the same run
+TEST(CompressedGraphTest, SimulationMatchesCsrGraph) {
+    std::default_random_engine random_gen{5};
+    Graph graph = generateRandomGraph(300, 0.2f, 0.03f, random_gen, ConnectivityPolicy::Retry);
+    // Node 0 gets a bitmap row
+    for (std::uint32_t v = 1; v < 300; v += 2) {
+        if (!boost::edge(0, v, graph).second) {
+            boost::add_edge(0, v, graph);
+        }
+    }
+
+    for (bool coroutine : {false, true}) {
+        auto run = [&](auto source) {
+            using NodeType = typename decltype(source)::vertex_bundled;
+            using PoissonDelay = AsyncDelay<std::poisson_distribution<std::uint32_t>>;
+            CsrGraph<NodeType> csr{source};
+            CompressedGraph<NodeType> compressed{source};
+            AsyncSimulation<PoissonDelay, SilentLogging, CsrGraph<NodeType>> csr_simulation{csr, PoissonDelay{std::poisson_distribution<std::uint32_t>{4.0}}, 9};
+            AsyncSimulation<PoissonDelay, SilentLogging, CompressedGraph<NodeType>> simulation{compressed, PoissonDelay{std::poisson_distribution<std::uint32_t>{4.0}}, 9};
+            ASSERT_EQ(simulation.run(), csr_simulation.run());
+            for (std::uint32_t v = 0; v < 300; ++v) {
+                ASSERT_EQ(compressed[v]._x, csr[v]._x);
+                ASSERT_EQ(compressed[v]._d, csr[v]._d);
+                ASSERT_EQ(compressed[v]._pulse, csr[v]._pulse);
+            }
+        };
+        if (coroutine) {
+            run(makeCoroutineGraph(graph));
+        } else {
+            run(graph);
+        }
+    }
+}
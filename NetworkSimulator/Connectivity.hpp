@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Connected component of every vertex, numbered 0, 1, ... in the order of their smallest vertex
+struct ComponentLabels
+{
+    std::vector<std::uint32_t> _labels;
+    std::uint32_t _num_components = 0;
+};
+
+namespace detail
+{
+    constexpr std::uint32_t unlabeled = std::numeric_limits<std::uint32_t>::max();
+
+    // Breadth-first search from source over the unlabeled vertices, gives them the label and returns how many there were
+    template <typename GraphType>
+    std::uint32_t labelComponent(const GraphType &g, std::uint32_t source, std::uint32_t label, std::vector<std::uint32_t> &labels, std::vector<std::uint32_t> &queue)
+    {
+        queue.clear();
+        queue.push_back(source);
+        labels[source] = label;
+        const std::size_t n = labels.size();
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            auto [begin, end] = adjacent_vertices(queue[head], g);
+            for (auto it = begin; it != end; ++it)
+            {
+                // Neighbors are always below n, but GCC can't tell an implicit topology never yields
+                // its empty slot marker here, and warns about the index without the bound
+                const std::uint32_t neighbor = *it;
+                if (neighbor < n && labels[neighbor] == unlabeled)
+                {
+                    labels[neighbor] = label;
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+        return queue.size();
+    }
+}
+
+// Labels the connected components with one breadth-first search each, O(n + m) time and O(n) memory.
+// Runs on the calling thread, on any of the simulator graphs (Graph, CsrGraph, implicit, compressed or mapped topologies).
+template <typename GraphType>
+ComponentLabels labelComponents(const GraphType &g)
+{
+    const std::uint32_t n = num_vertices(g);
+    ComponentLabels components{std::vector<std::uint32_t>(n, detail::unlabeled), 0};
+    std::vector<std::uint32_t> queue;
+    queue.reserve(n);
+    for (std::uint32_t v = 0; v < n; ++v)
+    {
+        if (components._labels[v] == detail::unlabeled)
+        {
+            detail::labelComponent(g, v, components._num_components++, components._labels, queue);
+        }
+    }
+    return components;
+}
+
+// Whether every vertex is reachable from vertex 0, with a single breadth-first search
+template <typename GraphType>
+bool isConnected(const GraphType &g)
+{
+    const std::uint32_t n = num_vertices(g);
+    if (n <= 1)
+    {
+        return true;
+    }
+    std::vector<std::uint32_t> labels(n, detail::unlabeled);
+    std::vector<std::uint32_t> queue;
+    queue.reserve(n);
+    return detail::labelComponent(g, 0, 0, labels, queue) == n;
+}
@@ -0,0 +1,141 @@
+#include "GraphGen.hpp"
+#include "Connectivity.hpp"
+#include "UnionFind.hpp"
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::uint32_t largestComponent(const ComponentLabels &components) {
+    std::vector<std::uint32_t> sizes(components._num_components, 0);
+    for (std::uint32_t label : components._labels) {
+        ++sizes[label];
+    }
+    return *std::max_element(sizes.begin(), sizes.end());
+}
+
+}
+
+TEST(UnionFindTest, TracksTheSets) {
+    UnionFind sets{6};
+    ASSERT_EQ(sets.size(), 6);
+    ASSERT_EQ(sets.num_sets(), 6);
+    ASSERT_TRUE(sets.unite(0, 1));
+    ASSERT_TRUE(sets.unite(2, 3));
+    ASSERT_TRUE(sets.unite(1, 3));
+    ASSERT_FALSE(sets.unite(0, 2));
+    ASSERT_EQ(sets.num_sets(), 3);
+    ASSERT_EQ(sets.find(0), sets.find(3));
+    ASSERT_NE(sets.find(0), sets.find(4));
+    ASSERT_EQ(sets.set_size(2), 4);
+    ASSERT_EQ(sets.set_size(5), 1);
+}
+
+TEST(ConnectivityTest, LabelsComponentsInOrderOfTheirSmallestVertex) {
+    CsrGraph<> graph{5, {{3, 1}, {2, 4}}};
+    ComponentLabels components = labelComponents(graph);
+    ASSERT_EQ(components._num_components, 3);
+    ASSERT_EQ(components._labels, (std::vector<std::uint32_t>{0, 1, 2, 1, 2}));
+    ASSERT_FALSE(isConnected(graph));
+    ASSERT_TRUE(isConnected(CsrGraph<>{3, {{0, 2}, {2, 1}}}));
+}
+
+TEST(ConnectivityPolicyTest, ParsesThePolicyNames) {
+    ASSERT_EQ(parseConnectivityPolicy("none"), ConnectivityPolicy::Unchecked);
+    ASSERT_EQ(parseConnectivityPolicy("retry"), ConnectivityPolicy::Retry);
+    ASSERT_EQ(parseConnectivityPolicy("giant"), ConnectivityPolicy::GiantComponent);
+    ASSERT_EQ(parseConnectivityPolicy("bridge"), ConnectivityPolicy::Bridge);
+    ASSERT_THROW(parseConnectivityPolicy("connected"), std::runtime_error);
+}
+
+// Just above the connectivity threshold ln(n) / n, most samples are connected
+TEST(ConnectivityPolicyTest, RetryReturnsAConnectedSample) {
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        std::default_random_engine random_gen{seed};
+        Graph g = generateRandomGraph(200, 0.5f, 0.035f, random_gen, ConnectivityPolicy::Retry);
+        ASSERT_EQ(boost::num_vertices(g), 200);
+        ASSERT_TRUE(isConnected(g));
+    }
+}
+
+// With mean degree 2 the sample has many components, and the same seed gives the same sample under every policy
+TEST(ConnectivityPolicyTest, BridgeAddsOneEdgePerComponent) {
+    std::default_random_engine sample_gen{7};
+    Graph sample = generateRandomGraph(200, 0.5f, 0.01f, sample_gen);
+    ComponentLabels components = labelComponents(sample);
+    ASSERT_GT(components._num_components, 1);
+
+    std::default_random_engine random_gen{7};
+    Graph g = generateRandomGraph(200, 0.5f, 0.01f, random_gen, ConnectivityPolicy::Bridge);
+    ASSERT_EQ(boost::num_vertices(g), 200);
+    ASSERT_EQ(boost::num_edges(g), boost::num_edges(sample) + components._num_components - 1);
+    ASSERT_TRUE(isConnected(g));
+}
+
+TEST(ConnectivityPolicyTest, GiantComponentKeepsTheLargestComponent) {
+    std::default_random_engine sample_gen{7};
+    Graph sample = generateRandomGraphWithEdgeCount(200, 0.5f, 200, sample_gen);
+    ComponentLabels components = labelComponents(sample);
+    ASSERT_GT(components._num_components, 1);
+
+    std::default_random_engine random_gen{7};
+    Graph g = generateRandomGraphWithEdgeCount(200, 0.5f, 200, random_gen, ConnectivityPolicy::GiantComponent);
+    ASSERT_EQ(boost::num_vertices(g), largestComponent(components));
+    ASSERT_TRUE(isConnected(g));
+    for (std::uint32_t v = 0; v < boost::num_vertices(g); ++v) {
+        ASSERT_EQ(g[v]._id, v);
+        ASSERT_EQ(g[v]._x, v);
+    }
+}
+
+// The parallel generators get the same policies through generateConnectedCsrGraph
+TEST(ConnectivityPolicyTest, CsrRetryReturnsAConnectedSample) {
+    auto generate = [](std::uint64_t seed) { return generateRandomCsrGraph(200, 0.035, seed, 2); };
+    for (std::uint64_t seed = 0; seed < 5; ++seed) {
+        CsrGraph<> g = generateConnectedCsrGraph(ConnectivityPolicy::Retry, seed, 2, generate);
+        ASSERT_EQ(g.num_vertices(), 200);
+        ASSERT_TRUE(isConnected(g));
+    }
+    ASSERT_THROW(generateConnectedCsrGraph(ConnectivityPolicy::Retry, 0, 2, [](std::uint64_t seed) { return generateRandomCsrGraph(200, 0.0, seed, 2); }),
+                 std::runtime_error);
+}
+
+TEST(ConnectivityPolicyTest, CsrBridgeAddsOneEdgePerComponent) {
+    auto generate = [](std::uint64_t seed) { return generateRandomCsrGraph(200, 0.01, seed, 2); };
+    CsrGraph<> sample = generate(7);
+    ComponentLabels components = labelComponents(sample);
+    ASSERT_GT(components._num_components, 1);
+
+    CsrGraph<> g = generateConnectedCsrGraph(ConnectivityPolicy::Bridge, 7, 2, generate);
+    ASSERT_EQ(g.num_vertices(), 200);
+    ASSERT_EQ(g.num_edges(), sample.num_edges() + components._num_components - 1);
+    ASSERT_TRUE(isConnected(g));
+    for (std::uint32_t v = 0; v < 200; ++v) {
+        auto [begin, end] = g.adjacency(v);
+        auto [sample_begin, sample_end] = sample.adjacency(v);
+        ASSERT_TRUE(std::includes(begin, end, sample_begin, sample_end)) << "vertex " << v;
+        ASSERT_EQ(g[v]._id, v);
+    }
+}
+
+// R-MAT graphs have isolated vertices, the giant component is what remains usable
+TEST(ConnectivityPolicyTest, CsrGiantComponentKeepsTheLargestComponent) {
+    auto generate = [](std::uint64_t seed) { return generateRmatCsrGraph(10, 4, seed, {}, 2); };
+    CsrGraph<> sample = generate(3);
+    ComponentLabels components = labelComponents(sample);
+    ASSERT_GT(components._num_components, 1);
+
+    CsrGraph<> g = generateConnectedCsrGraph(ConnectivityPolicy::GiantComponent, 3, 2, generate);
+    ASSERT_EQ(g.num_vertices(), largestComponent(components));
+    ASSERT_TRUE(isConnected(g));
+    std::uint64_t endpoints = 0;
+    for (std::uint32_t v = 0; v < g.num_vertices(); ++v) {
+        ASSERT_EQ(g[v]._id, v);
+        ASSERT_EQ(g[v]._x, v);
+        endpoints += g.degree(v);
+    }
+    ASSERT_EQ(endpoints, 2 * g.num_edges());
+    ASSERT_EQ(generateConnectedCsrGraph(ConnectivityPolicy::Unchecked, 3, 2, generate).num_vertices(), 1024);
+}
@@ -0,0 +1,459 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <boost/graph/adjacency_list.hpp>
+
+#include "Node.hpp"
+
+// Free-list allocator for coroutine frames. There is one pool per algorithm, and run_algorithm is
+// templated on the context, so its frames differ in size between graph types. Every frame size gets
+// its own free list, the block size of which is fixed by the first allocation of that size.
+// Blocks are carved out of large chunks, which keeps 1M frames from hitting the global heap 1M times.
+template <typename Algorithm>
+class CoroutineFramePool
+{
+public:
+    // Number of frames to carve out of the first chunk of every size, call before the nodes wake up
+    static void reserve(std::size_t num_frames)
+    {
+        _first_chunk_frames = std::max<std::size_t>(num_frames, 1);
+    }
+
+    static void *allocate(std::size_t size)
+    {
+        SizeClass &size_class = find_size_class(size);
+        if (size_class.free_list == nullptr)
+        {
+            grow(size_class);
+        }
+
+        FreeBlock *block = size_class.free_list;
+        size_class.free_list = block->next;
+        return block;
+    }
+
+    static void deallocate(void *ptr, std::size_t size)
+    {
+        SizeClass &size_class = find_size_class(size);
+        auto *block = static_cast<FreeBlock *>(ptr);
+        block->next = size_class.free_list;
+        size_class.free_list = block;
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    struct SizeClass
+    {
+        std::size_t block_size;
+        std::size_t chunk_frames;
+        FreeBlock *free_list = nullptr;
+    };
+
+    static std::size_t round_up(std::size_t size)
+    {
+        constexpr std::size_t alignment = alignof(std::max_align_t);
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    // A program runs an algorithm on one or two graph types, so the list stays a few entries long
+    static SizeClass &find_size_class(std::size_t size)
+    {
+        const std::size_t block_size = round_up(std::max(size, sizeof(FreeBlock)));
+        for (auto &size_class : _size_classes)
+        {
+            if (size_class.block_size == block_size)
+            {
+                return size_class;
+            }
+        }
+        return _size_classes.emplace_back(SizeClass{block_size, _first_chunk_frames});
+    }
+
+    static void grow(SizeClass &size_class)
+    {
+        auto &chunk = _chunks.emplace_back(std::make_unique<std::byte[]>(size_class.block_size * size_class.chunk_frames));
+
+        for (std::size_t i = size_class.chunk_frames; i-- > 0;)
+        {
+            auto *block = reinterpret_cast<FreeBlock *>(chunk.get() + i * size_class.block_size);
+            block->next = size_class.free_list;
+            size_class.free_list = block;
+        }
+
+        // Following chunks grow geometrically so the number of chunks stays logarithmic
+        size_class.chunk_frames *= 2;
+    }
+
+    static inline std::size_t _first_chunk_frames = 1024;
+    // A deque, so that growing it keeps the references handed out by find_size_class valid
+    static inline std::deque<SizeClass> _size_classes{};
+    static inline std::vector<std::unique_ptr<std::byte[]>> _chunks{};
+};
+
+// Return type of a node algorithm written as a coroutine.
+// The coroutine starts eagerly when the node wakes up and runs until its first co_await.
+template <typename Algorithm>
+class NodeTask
+{
+public:
+    struct promise_type
+    {
+        NodeTask get_return_object()
+        {
+            return NodeTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+
+        // Stay suspended at the end so that the owner can query done() before destroying the frame
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+
+        void unhandled_exception() { throw; }
+
+        static void *operator new(std::size_t size)
+        {
+            return CoroutineFramePool<Algorithm>::allocate(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size)
+        {
+            CoroutineFramePool<Algorithm>::deallocate(ptr, size);
+        }
+    };
+
+    NodeTask() = default;
+
+    NodeTask(NodeTask &&other) noexcept : _handle{std::exchange(other._handle, {})} {}
+
+    NodeTask &operator=(NodeTask &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+
+    NodeTask(const NodeTask &) = delete;
+    NodeTask &operator=(const NodeTask &) = delete;
+
+    ~NodeTask() { reset(); }
+
+    bool valid() const { return static_cast<bool>(_handle); }
+    bool done() const { return _handle.done(); }
+    void resume() const { _handle.resume(); }
+
+    void reset()
+    {
+        if (_handle)
+        {
+            _handle.destroy();
+            _handle = {};
+        }
+    }
+
+private:
+    explicit NodeTask(std::coroutine_handle<promise_type> handle) : _handle{handle} {}
+
+    std::coroutine_handle<promise_type> _handle{};
+};
+
+// What a coroutine sees of the network: its neighbors, its mailbox and the message sender.
+// It is passed by value to the coroutine so it lives in the coroutine frame. The neighbors are
+// a range into the graph, which topology changes can move or resize, so the owning node hands
+// the current range to the frame's copy through frame_context before every resume.
+template <typename PropertyMap, typename Iterator, typename MessageSender>
+class NodeContext
+{
+public:
+    NodeContext(MessageBuffer &incoming_messages, void *&frame_context, const PropertyMap &id_map, const Iterator &adjacent_begin, const Iterator &adjacent_end, const MessageSender &message_sender)
+        : _incoming_messages{&incoming_messages}, _frame_context{&frame_context}, _id_map{id_map}, _adjacent_begin{adjacent_begin}, _adjacent_end{adjacent_end}, _message_sender{message_sender} {}
+
+    void set_adjacency(const Iterator &adjacent_begin, const Iterator &adjacent_end)
+    {
+        _adjacent_begin = adjacent_begin;
+        _adjacent_end = adjacent_end;
+    }
+
+    void broadcast(const Message &message) const
+    {
+        for (auto it = _adjacent_begin; it != _adjacent_end; ++it)
+        {
+            _message_sender(_id_map[*it], message);
+        }
+    }
+
+    // Awaitable returning the oldest message from each neighbor, in adjacency order.
+    // The coroutine only suspends if some neighbor hasn't sent anything yet.
+    auto receive_from_all_neighbors()
+    {
+        // Called on the copy in the frame, which is the one to update when the node resumes
+        *_frame_context = this;
+
+        struct Awaiter
+        {
+            const NodeContext *context;
+
+            bool await_ready() const { return context->has_neighbors() && context->all_messages_received(); }
+            void await_suspend(std::coroutine_handle<>) const {}
+            std::vector<Message> await_resume() const { return context->take_oldest_messages(); }
+        };
+
+        return Awaiter{this};
+    }
+
+    // A node left without neighbors by a topology change has no pulse to run, although it trivially
+    // has a message from each of them
+    bool has_neighbors() const { return _adjacent_begin != _adjacent_end; }
+
+    bool all_messages_received() const
+    {
+        return std::all_of(
+            _adjacent_begin,
+            _adjacent_end,
+            [this](auto descriptor)
+            {
+                return _incoming_messages->find(_id_map[descriptor]) != _incoming_messages->end();
+            });
+    }
+
+private:
+    std::vector<Message> take_oldest_messages() const
+    {
+        std::vector<Message> to_process;
+        for (auto it = _adjacent_begin; it != _adjacent_end; ++it)
+        {
+            auto oldest = _incoming_messages->lower_bound(_id_map[*it]);
+            to_process.push_back(oldest->second);
+            _incoming_messages->erase(oldest);
+        }
+        return to_process;
+    }
+
+    MessageBuffer *_incoming_messages;
+    void **_frame_context;
+    PropertyMap _id_map;
+    Iterator _adjacent_begin;
+    Iterator _adjacent_end;
+    MessageSender _message_sender;
+};
+
+// Adapts an algorithm written as a coroutine to the run_logic interface used by AsyncSimulation.
+// Derived must provide
+//     template <typename Context> NodeTask<Derived> run_algorithm(Context context);
+// which is started when the node wakes up and is resumed whenever its mailbox holds
+// a message from every neighbor. The node terminates when the coroutine returns.
+template <typename Derived>
+class CoroutineNode
+{
+public:
+    std::uint32_t _id;
+    bool _initiator = false;
+
+    bool _awake = false;
+    bool _terminated = false;
+    std::uint32_t _x = _id;
+    MessageBuffer _incoming_messages{};
+
+    template <typename PropertyMap, typename Iterator, typename MessageSender>
+    bool run_logic(const PropertyMap &id_map, const Iterator &adjacent_begin, const Iterator &adjacent_end, const MessageSender &message_sender)
+    {
+        if (_terminated)
+        {
+            return true;
+        }
+
+        if (!_awake)
+        {
+            if (!_initiator && _incoming_messages.empty())
+            {
+                return false;
+            }
+
+            _awake = true;
+            _task = static_cast<Derived *>(this)->run_algorithm(
+                NodeContext<PropertyMap, Iterator, MessageSender>{_incoming_messages, _frame_context, id_map, adjacent_begin, adjacent_end, message_sender});
+        }
+        else
+        {
+            // The coroutine is suspended in receive_from_all_neighbors, which registered its context
+            auto *context = static_cast<NodeContext<PropertyMap, Iterator, MessageSender> *>(_frame_context);
+            context->set_adjacency(adjacent_begin, adjacent_end);
+            if (context->has_neighbors() && context->all_messages_received())
+            {
+                _task.resume();
+            }
+        }
+
+        if (_task.done())
+        {
+            // Give the frame back to the pool straight away, a terminated node never runs again
+            _task.reset();
+            _terminated = true;
+        }
+
+        return _terminated;
+    }
+
+protected:
+    CoroutineNode() = default;
+
+    CoroutineNode(const CoroutineNode &other)
+        : _id{other._id}, _initiator{other._initiator}, _awake{other._awake}, _terminated{other._terminated}, _x{other._x}, _incoming_messages{other._incoming_messages} {}
+
+    CoroutineNode &operator=(const CoroutineNode &other)
+    {
+        _id = other._id;
+        _initiator = other._initiator;
+        _awake = other._awake;
+        _terminated = other._terminated;
+        _x = other._x;
+        _incoming_messages = other._incoming_messages;
+        return *this;
+    }
+
+private:
+    // Frames are not copyable, a copied node starts without one (graphs are only copied before running)
+    NodeTask<Derived> _task{};
+    // Context in the frame of the suspended coroutine, of the type run_logic is instantiated with
+    void *_frame_context = nullptr;
+};
+
+// Peleg's leader election from Node.hpp written as a coroutine, one loop iteration per pulse
+class PelegCoroutineNode : public CoroutineNode<PelegCoroutineNode>
+{
+public:
+    std::uint32_t _c = 0;
+    std::int32_t _d = 0;
+    std::int32_t _b = 1;
+    std::uint32_t _pulse = 0;
+
+    // Same as Node, a new neighbor gets this node's current state or its completion signal
+    template <typename MessageSender>
+    void neighbor_added(std::uint32_t neighbor_id, const MessageSender &message_sender) const
+    {
+        if (_awake)
+        {
+            message_sender(neighbor_id, Message{_x, _d});
+        }
+    }
+
+    // Undelivered messages on a deleted link are dropped
+    void neighbor_removed(std::uint32_t neighbor_id)
+    {
+        _incoming_messages.erase(neighbor_id);
+    }
+
+    template <typename Context>
+    NodeTask<PelegCoroutineNode> run_algorithm(Context context)
+    {
+        context.broadcast(Message{_x, _d});
+
+        while (true)
+        {
+            std::vector<Message> to_process = co_await context.receive_from_all_neighbors();
+            ++_pulse;
+
+            // Completion signal received
+            if (std::any_of(to_process.begin(), to_process.end(), [](const auto &message)
+                            { return message.d == -1; }))
+            {
+                std::cout << "completion signal received by node " << _id << std::endl;
+                _d = -1;
+                context.broadcast(Message{_x, _d});
+                co_return;
+            }
+
+            // Highest node id this node has heard of
+            std::uint32_t y = std::max_element(to_process.begin(), to_process.end(), [](const auto &a, const auto &b)
+                                               { return a.x < b.x; })
+                                  ->x;
+
+            if (y > _x)
+            {
+                _b = 0;
+                _x = y;
+                _d = _pulse;
+            }
+
+            if (_b != 0)
+            {
+                if (y < _x)
+                {
+                    _c = 1;
+                }
+                else
+                {
+                    // Longest distance to a known node
+                    std::int32_t z = std::max_element(to_process.begin(), to_process.end(), [](const auto &a, const auto &b)
+                                                      { return a.d < b.d; })
+                                         ->d;
+
+                    if (z > _d)
+                    {
+                        _d = z;
+                        _c = 0;
+                    }
+                    else
+                    {
+                        ++_c;
+                    }
+
+                    if (_c == 2)
+                    {
+                        // Completion, current node is the leader
+                        _d = -1;
+                        context.broadcast(Message{_x, _d});
+                        co_return;
+                    }
+                }
+            }
+
+            context.broadcast(Message{_x, _d});
+        }
+    }
+};
+
+using CoroutineGraph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, PelegCoroutineNode, boost::no_property>;
+
+// Copies the topology and the initial node state of a generated graph into a graph of coroutine nodes
+inline CoroutineGraph makeCoroutineGraph(const Graph &g)
+{
+    CoroutineGraph coroutine_graph;
+
+    auto [vertices_begin, vertices_end] = boost::vertices(g);
+    for (auto it = vertices_begin; it != vertices_end; ++it)
+    {
+        auto descriptor = boost::add_vertex(PelegCoroutineNode(), coroutine_graph);
+        coroutine_graph[descriptor]._id = g[*it]._id;
+        coroutine_graph[descriptor]._x = g[*it]._x;
+        coroutine_graph[descriptor]._initiator = g[*it]._initiator;
+    }
+
+    auto [edges_begin, edges_end] = boost::edges(g);
+    for (auto it = edges_begin; it != edges_end; ++it)
+    {
+        boost::add_edge(boost::source(*it, g), boost::target(*it, g), coroutine_graph);
+    }
+
+    CoroutineFramePool<PelegCoroutineNode>::reserve(boost::num_vertices(g));
+
+    return coroutine_graph;
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+#include "Parallel.hpp"
+
+struct CsrBuildOptions
+{
+    // Drop edges (v, v)
+    bool _remove_self_loops = true;
+    // Keep one copy of edges given several times, in either direction
+    bool _deduplicate = true;
+    // 0 uses every core
+    std::uint32_t _num_threads = 0;
+};
+
+// Builds a CsrGraph from undirected edges produced in chunks, possibly by several threads at once.
+// build() runs a parallel degree count into one shared array of atomic counters, a parallel prefix
+// sum of the degrees and a parallel scatter of both directions of every edge, then sorts (and
+// deduplicates) each neighbor list.
+// The scatter order depends on the thread timing, but the sort doesn't, so the result doesn't
+// depend on the number of threads.
+// Nodes get _id = _x = their index, as with the other CsrGraph constructors.
+template <typename NodeType = Node>
+class CsrBuilder
+{
+public:
+    using Edge = std::pair<std::uint32_t, std::uint32_t>;
+
+    explicit CsrBuilder(std::uint32_t num_vertices, CsrBuildOptions options = {})
+        : _num_vertices{num_vertices}, _options{options}
+    {
+        if (_options._num_threads == 0)
+        {
+            _options._num_threads = defaultThreadCount();
+        }
+    }
+
+    // Safe to call from several producer threads, the chunk is moved in without copying
+    void add_edges(std::vector<Edge> chunk)
+    {
+        std::lock_guard lock{_chunks_mutex};
+        _num_edges += chunk.size();
+        _chunks.push_back(std::move(chunk));
+    }
+
+    // Consumes the edges added so far
+    CsrGraph<NodeType> build()
+    {
+        std::vector<std::vector<Edge>> chunks;
+        {
+            std::lock_guard lock{_chunks_mutex};
+            chunks = std::move(_chunks);
+            _chunks.clear();
+            _num_edges = 0;
+        }
+
+        std::vector<std::uint64_t> chunk_starts{0};
+        for (const auto &chunk : chunks)
+        {
+            chunk_starts.push_back(chunk_starts.back() + chunk.size());
+        }
+
+        // Calls body(u, v) for the edges with global index in [begin, end)
+        auto for_each_edge = [&](std::uint64_t begin, std::uint64_t end, const auto &body)
+        {
+            std::size_t chunk = std::upper_bound(chunk_starts.begin(), chunk_starts.end(), begin) - chunk_starts.begin() - 1;
+            for (std::uint64_t e = begin; e < end; ++chunk)
+            {
+                const std::uint64_t chunk_end = std::min(end, chunk_starts[chunk + 1]);
+                for (; e < chunk_end; ++e)
+                {
+                    const auto &[u, v] = chunks[chunk][e - chunk_starts[chunk]];
+                    body(u, v);
+                }
+            }
+        };
+
+        const std::uint32_t n = _num_vertices;
+        const std::uint32_t num_threads = _options._num_threads;
+        const bool remove_self_loops = _options._remove_self_loops;
+        const std::uint64_t num_edges = chunk_starts.back();
+
+        // Calls body(u, v) and body(v, u) for the edges with index in [begin, end) that are kept
+        auto for_each_endpoint = [&](std::uint64_t begin, std::uint64_t end, const auto &body)
+        {
+            for_each_edge(begin, end, [&](std::uint32_t u, std::uint32_t v)
+                          {
+                              if (remove_self_loops && u == v)
+                              {
+                                  return;
+                              }
+                              body(u, v);
+                              // A kept self loop is listed once
+                              if (v != u)
+                              {
+                                  body(v, u);
+                              } });
+        };
+
+        // One 32 bit counter per vertex, shared by the threads through atomic_ref, so the extra memory
+        // is 4n bytes whatever the number of threads. Endpoints are checked before they are counted.
+        std::vector<std::uint32_t> degrees(n, 0);
+        std::vector<char> out_of_range(num_threads, false);
+        parallelFor(0, num_edges, num_threads, [&](std::uint32_t thread, std::uint64_t begin, std::uint64_t end)
+                    {
+                        bool invalid = false;
+                        for_each_edge(begin, end, [&](std::uint32_t u, std::uint32_t v)
+                                      { invalid |= u >= n || v >= n; });
+                        out_of_range[thread] = invalid;
+                        if (invalid)
+                        {
+                            return;
+                        }
+                        for_each_endpoint(begin, end, [&](std::uint32_t owned, std::uint32_t)
+                                          { std::atomic_ref<std::uint32_t>{degrees[owned]}.fetch_add(1, std::memory_order_relaxed); }); });
+        if (std::find(out_of_range.begin(), out_of_range.end(), true) != out_of_range.end())
+        {
+            throw std::runtime_error("Edge endpoint out of range.");
+        }
+
+        std::vector<std::uint64_t> offsets(static_cast<std::uint64_t>(n) + 1, 0);
+        parallelFor(0, n, num_threads, [&](std::uint32_t, std::uint64_t first, std::uint64_t last)
+                    { std::copy(degrees.begin() + first, degrees.begin() + last, offsets.begin() + first); });
+        parallelExclusiveScan(offsets, num_threads);
+
+        // Both directions of every edge. The degrees count down as the cursors of the neighbor lists,
+        // which are filled from the end
+        std::vector<std::uint32_t> neighbors(offsets.back());
+        parallelFor(0, num_edges, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                    {
+                        for_each_endpoint(begin, end, [&](std::uint32_t owned, std::uint32_t other)
+                                          {
+                                              const std::uint32_t slot = std::atomic_ref<std::uint32_t>{degrees[owned]}.fetch_sub(1, std::memory_order_relaxed) - 1;
+                                              neighbors[offsets[owned] + slot] = other;
+                                          }); });
+        degrees.clear();
+        degrees.shrink_to_fit();
+        chunks.clear();
+        chunks.shrink_to_fit();
+
+        // Sorts each neighbor list. Work is split by edges rather than vertices so that
+        // high degree vertices don't all land on one thread.
+        std::vector<std::uint64_t> kept(n + 1, 0);
+        parallelFor(0, offsets.back(), num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                    {
+                        // Vertices whose first edge is in [begin, end)
+                        std::uint32_t v = std::lower_bound(offsets.begin(), offsets.end() - 1, begin) - offsets.begin();
+                        for (; v < n && offsets[v] < end; ++v)
+                        {
+                            auto row_begin = neighbors.begin() + offsets[v];
+                            auto row_end = neighbors.begin() + offsets[v + 1];
+                            std::sort(row_begin, row_end);
+                            kept[v] = _options._deduplicate ? std::unique(row_begin, row_end) - row_begin : row_end - row_begin;
+                        } });
+
+        // Vertices with no edges were skipped above, which is fine since they keep 0
+        if (_options._deduplicate)
+        {
+            parallelExclusiveScan(kept, num_threads);
+            if (kept.back() != offsets.back())
+            {
+                std::vector<std::uint32_t> unique_neighbors(kept.back());
+                parallelFor(0, n, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                            {
+                                for (std::uint64_t v = begin; v < end; ++v)
+                                {
+                                    std::copy_n(neighbors.begin() + offsets[v], kept[v + 1] - kept[v], unique_neighbors.begin() + kept[v]);
+                                } });
+                neighbors = std::move(unique_neighbors);
+                offsets = std::move(kept);
+            }
+        }
+
+        std::vector<NodeType> nodes(n);
+        parallelFor(0, n, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                    {
+                        for (std::uint64_t v = begin; v < end; ++v)
+                        {
+                            nodes[v]._id = v;
+                            nodes[v]._x = v;
+                        } });
+
+        return CsrGraph<NodeType>{std::move(offsets), std::move(neighbors), std::move(nodes)};
+    }
+
+    std::uint64_t num_edges() const
+    {
+        std::lock_guard lock{_chunks_mutex};
+        return _num_edges;
+    }
+
+private:
+    std::uint32_t _num_vertices;
+    CsrBuildOptions _options;
+    mutable std::mutex _chunks_mutex{};
+    std::vector<std::vector<Edge>> _chunks{};
+    std::uint64_t _num_edges = 0;
+};
+
+// Single edge list version of CsrBuilder
+template <typename NodeType = Node>
+CsrGraph<NodeType> buildCsrGraph(std::uint32_t num_vertices, std::vector<std::pair<std::uint32_t, std::uint32_t>> edges, CsrBuildOptions options = {})
+{
+    CsrBuilder<NodeType> builder{num_vertices, options};
+    builder.add_edges(std::move(edges));
+    return builder.build();
+}
@@ -0,0 +1,92 @@
+#include "CsrBuilder.hpp"
+
+#include <random>
+#include <set>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+using Edge = std::pair<std::uint32_t, std::uint32_t>;
+
+std::vector<std::uint32_t> neighborsOf(const CsrGraph<> &graph, std::uint32_t v) {
+    auto [begin, end] = graph.adjacency(v);
+    return {begin, end};
+}
+
+std::vector<Edge> randomEdges(std::uint32_t num_vertices, std::uint64_t num_edges, std::uint64_t seed) {
+    std::mt19937_64 random_gen{seed};
+    std::uniform_int_distribution<std::uint32_t> vertex{0, num_vertices - 1};
+    std::vector<Edge> edges;
+    for (std::uint64_t i = 0; i < num_edges; ++i) {
+        edges.emplace_back(vertex(random_gen), vertex(random_gen));
+    }
+    return edges;
+}
+
+}
+
+TEST(CsrBuilderTest, SortsDeduplicatesAndDropsSelfLoops) {
+    CsrGraph<> graph = buildCsrGraph(4, {{0, 1}, {1, 0}, {2, 2}, {3, 1}, {0, 1}, {2, 0}});
+    ASSERT_EQ(graph.num_vertices(), 4);
+    ASSERT_EQ(graph.num_edges(), 3);
+    ASSERT_EQ(neighborsOf(graph, 0), (std::vector<std::uint32_t>{1, 2}));
+    ASSERT_EQ(neighborsOf(graph, 1), (std::vector<std::uint32_t>{0, 3}));
+    ASSERT_EQ(neighborsOf(graph, 2), (std::vector<std::uint32_t>{0}));
+    ASSERT_EQ(neighborsOf(graph, 3), (std::vector<std::uint32_t>{1}));
+    ASSERT_EQ(graph[2]._id, 2);
+}
+
+TEST(CsrBuilderTest, KeepsRepeatsAndSelfLoopsWhenAsked) {
+    CsrBuildOptions options;
+    options._remove_self_loops = false;
+    options._deduplicate = false;
+    CsrGraph<> graph = buildCsrGraph(3, {{0, 1}, {1, 0}, {2, 2}}, options);
+    ASSERT_EQ(neighborsOf(graph, 0), (std::vector<std::uint32_t>{1, 1}));
+    ASSERT_EQ(neighborsOf(graph, 1), (std::vector<std::uint32_t>{0, 0}));
+    // A self loop is listed once
+    ASSERT_EQ(neighborsOf(graph, 2), (std::vector<std::uint32_t>{2}));
+}
+
+TEST(CsrBuilderTest, RejectsEndpointsOutOfRange) {
+    ASSERT_THROW(buildCsrGraph(3, {{0, 1}, {1, 3}}), std::runtime_error);
+}
+
+TEST(CsrBuilderTest, HandlesNoEdgesAndNoVertices) {
+    ASSERT_EQ(buildCsrGraph(5, {}).num_edges(), 0);
+    ASSERT_EQ(buildCsrGraph(0, {}).num_vertices(), 0);
+}
+
+// Chunks added from several threads give the same graph for every number of build threads
+TEST(CsrBuilderTest, ResultDoesNotDependOnThreads) {
+    const std::uint32_t n = 500;
+    std::vector<Edge> edges = randomEdges(n, 6000, 3);
+
+    std::vector<std::set<std::uint32_t>> expected(n);
+    for (auto [u, v] : edges) {
+        if (u != v) {
+            expected[u].insert(v);
+            expected[v].insert(u);
+        }
+    }
+
+    for (std::uint32_t num_threads : {1, 2, 3, 8}) {
+        CsrBuildOptions options;
+        options._num_threads = num_threads;
+        CsrBuilder<> builder{n, options};
+        std::vector<std::jthread> producers;
+        for (std::size_t first = 0; first < edges.size(); first += 1000) {
+            producers.emplace_back([&, first] {
+                builder.add_edges(std::vector<Edge>(edges.begin() + first, edges.begin() + std::min(first + 1000, edges.size())));
+            });
+        }
+        producers.clear();
+        ASSERT_EQ(builder.num_edges(), edges.size());
+
+        CsrGraph<> graph = builder.build();
+        for (std::uint32_t v = 0; v < n; ++v) {
+            ASSERT_EQ(neighborsOf(graph, v), std::vector<std::uint32_t>(expected[v].begin(), expected[v].end())) << num_threads << " threads, vertex " << v;
+        }
+    }
+}
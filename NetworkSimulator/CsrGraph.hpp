@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "Node.hpp"
+
+// Read-only view of one member of every node, used the same way as boost::get(&Node::_id, g)
+template <typename NodeType, typename T>
+class NodeMemberMap
+{
+public:
+    NodeMemberMap(const NodeType *nodes, T NodeType::*member) : _nodes{nodes}, _member{member} {}
+
+    const T &operator[](std::uint32_t v) const { return _nodes[v].*_member; }
+
+private:
+    const NodeType *_nodes;
+    T NodeType::*_member;
+};
+
+// Traversal category shared by the graph types that only support vertex and adjacency iteration
+struct AdjacencyTraversalTag : public boost::adjacency_graph_tag, public boost::vertex_list_graph_tag
+{
+};
+
+// Undirected graph in compressed sparse row form: the neighbors of v are
+// _neighbors[_offsets[v]] ... _neighbors[_offsets[v + 1] - 1], sorted in increasing order.
+// The topology is immutable once built, only the node states can be modified.
+// The free functions below make it usable wherever a Graph is, with vertex descriptors
+// being indices in [0, num_vertices).
+template <typename NodeType = Node>
+class CsrGraph
+{
+public:
+    using vertex_descriptor = std::uint32_t;
+    using edge_descriptor = std::uint64_t;
+    using adjacency_iterator = const std::uint32_t *;
+    using vertex_iterator = boost::counting_iterator<std::uint32_t>;
+    using directed_category = boost::undirected_tag;
+    using edge_parallel_category = boost::disallow_parallel_edge_tag;
+    using traversal_category = AdjacencyTraversalTag;
+    using vertices_size_type = std::uint32_t;
+    using edges_size_type = std::uint64_t;
+    using degree_size_type = std::uint32_t;
+    using vertex_bundled = NodeType;
+
+    CsrGraph() = default;
+
+    // Builds the graph from a list of undirected edges, each edge is stored in both directions.
+    // Nodes get _id = _x = their index.
+    CsrGraph(std::uint32_t num_vertices, const std::vector<std::pair<std::uint32_t, std::uint32_t>> &edges)
+        : _offsets(num_vertices + 1, 0), _nodes(num_vertices)
+    {
+        for (const auto &[u, v] : edges)
+        {
+            ++_offsets[u + 1];
+            ++_offsets[v + 1];
+        }
+        std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+        _neighbors.resize(_offsets.back());
+        std::vector<std::uint64_t> cursors(_offsets.begin(), _offsets.end() - 1);
+        for (const auto &[u, v] : edges)
+        {
+            _neighbors[cursors[u]++] = v;
+            _neighbors[cursors[v]++] = u;
+        }
+
+        for (std::uint32_t v = 0; v < num_vertices; ++v)
+        {
+            _nodes[v]._id = v;
+            _nodes[v]._x = v;
+        }
+
+        sort_neighbors();
+    }
+
+    // Takes ownership of already built arrays, neighbor lists must be sorted
+    CsrGraph(std::vector<std::uint64_t> offsets, std::vector<std::uint32_t> neighbors, std::vector<NodeType> nodes)
+        : _offsets{std::move(offsets)}, _neighbors{std::move(neighbors)}, _nodes{std::move(nodes)}
+    {
+        if (_offsets.size() != _nodes.size() + 1 || _offsets.back() != _neighbors.size())
+        {
+            throw std::runtime_error("Offsets don't match the number of nodes and neighbors.");
+        }
+    }
+
+    // Builds the graph from any graph with vertex indices in [0, num_vertices) whose nodes are NodeType
+    // (e.g. the output of GraphGen.hpp or a MappedCsrGraph). Vertex indices and node states are kept as they are.
+    template <typename SourceGraph>
+    explicit CsrGraph(const SourceGraph &g)
+    {
+        // The member functions would hide the free ones, which are found through the source graph type
+        using boost::adjacent_vertices;
+        using boost::num_vertices;
+
+        const std::uint32_t n = num_vertices(g);
+        _offsets.reserve(n + 1);
+        _nodes.reserve(n);
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            auto [adjacent_begin, adjacent_end] = adjacent_vertices(v, g);
+            _neighbors.insert(_neighbors.end(), adjacent_begin, adjacent_end);
+            _offsets.push_back(_neighbors.size());
+            _nodes.push_back(g[v]);
+        }
+
+        sort_neighbors();
+    }
+
+    std::uint32_t num_vertices() const { return _nodes.size(); }
+
+    // Number of undirected edges
+    std::uint64_t num_edges() const { return _neighbors.size() / 2; }
+
+    std::uint32_t degree(std::uint32_t v) const { return _offsets[v + 1] - _offsets[v]; }
+
+    std::pair<adjacency_iterator, adjacency_iterator> adjacency(std::uint32_t v) const
+    {
+        return {_neighbors.data() + _offsets[v], _neighbors.data() + _offsets[v + 1]};
+    }
+
+    // Index of the first edge of v, edge e of v goes to _neighbors[first_edge(v) + e]
+    std::uint64_t first_edge(std::uint32_t v) const { return _offsets[v]; }
+
+    std::uint32_t edge_target(std::uint64_t edge) const { return _neighbors[edge]; }
+
+    // Computes, for every directed edge u -> v, the index of the edge v -> u.
+    // Only needed for per-edge state (e.g. per-edge mailboxes), so it isn't built by default.
+    void build_reverse_edges()
+    {
+        // Neighbor lists are sorted, so scanning u in increasing order visits the
+        // edges into v in the same order as v's own neighbor list
+        _reverse_edges.resize(_neighbors.size());
+        std::vector<std::uint64_t> cursors(_offsets.begin(), _offsets.end() - 1);
+        for (std::uint32_t u = 0; u < num_vertices(); ++u)
+        {
+            for (std::uint64_t e = _offsets[u]; e < _offsets[u + 1]; ++e)
+            {
+                _reverse_edges[e] = cursors[_neighbors[e]]++;
+            }
+        }
+    }
+
+    bool has_reverse_edges() const { return !_reverse_edges.empty() || _neighbors.empty(); }
+
+    std::uint64_t reverse_edge(std::uint64_t edge) const { return _reverse_edges[edge]; }
+
+    NodeType &operator[](std::uint32_t v) { return _nodes[v]; }
+    const NodeType &operator[](std::uint32_t v) const { return _nodes[v]; }
+    const NodeType *node_data() const { return _nodes.data(); }
+
+    // Bytes used by the topology (offsets, neighbors and reverse edges), excluding node states
+    std::uint64_t topology_bytes() const
+    {
+        return _offsets.capacity() * sizeof(std::uint64_t) + _neighbors.capacity() * sizeof(std::uint32_t) +
+               _reverse_edges.capacity() * sizeof(std::uint64_t);
+    }
+
+private:
+    void sort_neighbors()
+    {
+        for (std::uint32_t v = 0; v < num_vertices(); ++v)
+        {
+            std::sort(_neighbors.begin() + _offsets[v], _neighbors.begin() + _offsets[v + 1]);
+        }
+    }
+
+    std::vector<std::uint64_t> _offsets{0};
+    std::vector<std::uint32_t> _neighbors{};
+    std::vector<std::uint64_t> _reverse_edges{};
+    std::vector<NodeType> _nodes{};
+};
+
+template <typename NodeType>
+std::pair<boost::counting_iterator<std::uint32_t>, boost::counting_iterator<std::uint32_t>> vertices(const CsrGraph<NodeType> &g)
+{
+    return {0, g.num_vertices()};
+}
+
+template <typename NodeType>
+std::uint32_t num_vertices(const CsrGraph<NodeType> &g)
+{
+    return g.num_vertices();
+}
+
+template <typename NodeType>
+std::uint64_t num_edges(const CsrGraph<NodeType> &g)
+{
+    return g.num_edges();
+}
+
+template <typename NodeType>
+std::pair<const std::uint32_t *, const std::uint32_t *> adjacent_vertices(std::uint32_t v, const CsrGraph<NodeType> &g)
+{
+    return g.adjacency(v);
+}
+
+template <typename NodeType>
+std::uint32_t out_degree(std::uint32_t v, const CsrGraph<NodeType> &g)
+{
+    return g.degree(v);
+}
+
+// Member may be a base class of NodeType (e.g. &PelegCoroutineNode::_id is declared in CoroutineNode)
+template <typename NodeType, typename Member, typename T>
+NodeMemberMap<NodeType, T> get(T Member::*member, const CsrGraph<NodeType> &g)
+{
+    return {g.node_data(), member};
+}
+
+template <typename NodeType>
+void prefetchAdjacency(std::uint32_t v, const CsrGraph<NodeType> &g)
+{
+    prefetch(g.adjacency(v).first);
+}
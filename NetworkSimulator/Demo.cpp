@@ -4,11 +4,53 @@
 #include <tuple>
 #include <random>
 #include <cstdlib>
+#include <chrono>
+#include <optional>
+#include <array>
+#include <bit>
+#include <sstream>
 
 #include "Node.hpp"
 #include "GraphGen.hpp"
+#include "GeometricGraph.hpp"
+#include "BlockModel.hpp"
 #include "Diameter.hpp"
+#include "Connectivity.hpp"
 #include "AsyncSimulation.hpp"
+#include "CoroutineNode.hpp"
+#include "CsrGraph.hpp"
+#include "ImplicitGraph.hpp"
+#include "HashedRandomGraph.hpp"
+#include "VertexOrdering.hpp"
+#include "CompressedGraph.hpp"
+#include "MappedCsrGraph.hpp"
+#include "GraphImport.hpp"
+#include "DynamicGraph.hpp"
+
+// Dispatches once to the engine instantiation matching the runtime options,
+// the delay and logging policies are compile-time from there on
+template <typename GraphType>
+void runSimulation(GraphType &graph, bool sync, bool verbose, float time_delay, std::uint64_t random_seed, bool elide, std::uint32_t prefetch_distance,
+				   const std::vector<TopologyChange<std::uint32_t>> &topology_changes)
+{
+	using TimeType = std::uint32_t;
+	using PoissonDelay = AsyncDelay<std::poisson_distribution<TimeType>>;
+
+	auto run = [&](auto simulation)
+	{
+		simulation.schedule_topology_changes(topology_changes);
+		simulation.run();
+	};
+
+	if (sync && verbose)
+		run(AsyncSimulation<SyncDelay, VerboseLogging, GraphType>{graph, SyncDelay{}, random_seed, elide, prefetch_distance});
+	else if (sync)
+		run(AsyncSimulation<SyncDelay, SilentLogging, GraphType>{graph, SyncDelay{}, random_seed, elide, prefetch_distance});
+	else if (verbose)
+		run(AsyncSimulation<PoissonDelay, VerboseLogging, GraphType>{graph, PoissonDelay{std::poisson_distribution<TimeType>{time_delay}}, random_seed, elide, prefetch_distance});
+	else
+		run(AsyncSimulation<PoissonDelay, SilentLogging, GraphType>{graph, PoissonDelay{std::poisson_distribution<TimeType>{time_delay}}, random_seed, elide, prefetch_distance});
+}
 
 int main(int argc, char **argv)
 {
@@ -25,10 +67,121 @@ int main(int argc, char **argv)
 	bool s = true;
 	bool v = true;
 	bool d = false;
+	bool coroutine = false;
+	bool elide = false;
+	std::uint32_t prefetch_distance = 0;
+	bool csr = false;
+	bool implicit = false;
+	std::optional<VertexOrdering> reorder;
+	bool compressed = false;
+	std::string write_csr_path;
+	std::string changes_path;
+	std::uint64_t exact_edges = 0;
+	std::optional<std::uint64_t> seed_option;
+	std::uint32_t num_threads = 0;
+	std::uint32_t edges_per_node = 2;
+	double radius = 0.0;
+	std::uint32_t dimensions = 2;
+	std::uint32_t degree = 4;
+	std::uint32_t num_blocks = 2;
+	float inter_block_prob = 0.0f;
+	std::optional<std::uint32_t> scale_option;
+	std::uint32_t edge_factor = 16;
+	RmatParameters rmat_parameters;
+	std::string rmat_name = "0.57,0.19,0.19,0.05";
+	std::optional<ConnectivityPolicy> connect_option;
+	std::string connect_name = "retry";
+	std::vector<TopologyChange<std::uint32_t>> topology_changes;
+	std::string reorder_name = "none";
 
 	if (argc < 9)
 	{
-		std::cerr << "Usage : ./simulator <topology> <synchrony (s / n)> <time delay> <no. of nodes> <verbose (v / n> <initiator probability> <edge probability> <find diameter>";
+		std::cerr << "Usage : ./simulator <topology> <synchrony (s / n)> <time delay> <no. of nodes> <verbose (v / n> <initiator probability> <edge probability> <find diameter> [--coroutine] [--elide] [--prefetch <K>] [--csr] [--implicit] [--reorder <rcm / degree / gorder>] [--compressed] [--write-csr <path>] [--changes <path>] [--edges <m>] [--seed <seed>] [--threads <T>] [--attach <k>] [--radius <r>] [--dimensions <2 / 3>] [--degree <d>] [--blocks <k>] [--inter <q>] [--scale <s>] [--edge-factor <f>] [--rmat <a,b,c,d>] [--connect <retry / giant / bridge / none>]";
+		return 1;
+	}
+
+	// Optional flags after the positional arguments
+	for (int i = 9; i < argc; ++i)
+	{
+		std::string flag = argv[i];
+		if (flag == "--coroutine")
+			coroutine = true;
+		else if (flag == "--elide")
+			elide = true;
+		else if (flag == "--prefetch" && i + 1 < argc)
+			prefetch_distance = std::stoul(argv[++i]);
+		else if (flag == "--csr")
+			csr = true;
+		else if (flag == "--implicit")
+			implicit = true;
+		else if (flag == "--reorder" && i + 1 < argc)
+		{
+			reorder_name = argv[++i];
+			reorder = parseVertexOrdering(reorder_name);
+		}
+		else if (flag == "--compressed")
+			compressed = true;
+		else if (flag == "--write-csr" && i + 1 < argc)
+			write_csr_path = argv[++i];
+		else if (flag == "--changes" && i + 1 < argc)
+		{
+			changes_path = argv[++i];
+			topology_changes = readTopologyChanges(changes_path);
+		}
+		else if (flag == "--edges" && i + 1 < argc)
+			exact_edges = std::stoull(argv[++i]);
+		else if (flag == "--seed" && i + 1 < argc)
+			seed_option = std::stoull(argv[++i]);
+		else if (flag == "--threads" && i + 1 < argc)
+			num_threads = std::stoul(argv[++i]);
+		else if (flag == "--attach" && i + 1 < argc)
+			edges_per_node = std::stoul(argv[++i]);
+		else if (flag == "--radius" && i + 1 < argc)
+			radius = std::stod(argv[++i]);
+		else if (flag == "--dimensions" && i + 1 < argc)
+			dimensions = std::stoul(argv[++i]);
+		else if (flag == "--degree" && i + 1 < argc)
+			degree = std::stoul(argv[++i]);
+		else if (flag == "--blocks" && i + 1 < argc)
+			num_blocks = std::stoul(argv[++i]);
+		else if (flag == "--inter" && i + 1 < argc)
+			inter_block_prob = std::stof(argv[++i]);
+		else if (flag == "--scale" && i + 1 < argc)
+			scale_option = std::stoul(argv[++i]);
+		else if (flag == "--edge-factor" && i + 1 < argc)
+			edge_factor = std::stoul(argv[++i]);
+		else if (flag == "--rmat" && i + 1 < argc)
+		{
+			rmat_name = argv[++i];
+			std::istringstream fields{rmat_name};
+			std::array<double, 4> weights{};
+			char comma;
+			if (!(fields >> weights[0] >> comma >> weights[1] >> comma >> weights[2] >> comma >> weights[3]))
+			{
+				std::cerr << "Expected --rmat <a,b,c,d> : " << rmat_name << std::endl;
+				return 1;
+			}
+			double total = weights[0] + weights[1] + weights[2] + weights[3];
+			rmat_parameters._a = weights[0] / total;
+			rmat_parameters._b = weights[1] / total;
+			rmat_parameters._c = weights[2] / total;
+		}
+		else if (flag == "--connect" && i + 1 < argc)
+		{
+			connect_name = argv[++i];
+			connect_option = parseConnectivityPolicy(connect_name);
+		}
+		else
+		{
+			std::cerr << "Unknown option : " << flag << std::endl;
+			return 1;
+		}
+	}
+
+	// Compressed neighbor lists can't be edited in place
+	if (compressed && !topology_changes.empty())
+	{
+		std::cerr << "--compressed can't be combined with --changes" << std::endl;
 		return 1;
 	}
 
@@ -41,6 +194,29 @@ int main(int argc, char **argv)
 	edge_prob = std::stof(argv[7]);
 	find_diameter = argv[8];
 
+	// --edges switches the random topology from G(n, p) to G(n, m)
+	if (exact_edges > 0 && topology != "random")
+	{
+		std::cerr << "--edges only applies to the random topology" << std::endl;
+		return 1;
+	}
+	// Implicit topologies have no stored neighbor lists to copy, reorder or edit
+	if (implicit && (csr || reorder.has_value() || compressed || !topology_changes.empty() || !write_csr_path.empty() || exact_edges > 0))
+	{
+		std::cerr << "--implicit can't be combined with --csr, --reorder, --compressed, --changes, --write-csr or --edges" << std::endl;
+		return 1;
+	}
+	// Loaded and implicit topologies are used as they are
+	if (connect_option.has_value() && (implicit || topology.rfind("file:", 0) == 0))
+	{
+		std::cerr << "--connect only applies to generated topologies, not to --implicit or file:" << std::endl;
+		return 1;
+	}
+	// R-MAT graphs almost always have isolated vertices, so resampling them would never succeed
+	if (!connect_option.has_value() && topology == "rmat")
+		connect_name = "giant";
+	ConnectivityPolicy connect_policy = connect_option.value_or(topology == "rmat" ? ConnectivityPolicy::GiantComponent : ConnectivityPolicy::Retry);
+
 	std::cout << "topology : " << topology << std::endl;
 	std::cout << "synchrony : " << synchrony << std::endl;
 	std::cout << "time_delay : " << time_delay << std::endl;
@@ -49,7 +225,30 @@ int main(int argc, char **argv)
 	std::cout << "initiator_prob : " << initiator_prob << std::endl;
 	std::cout << "edge_prob : " << edge_prob << std::endl;
 	std::cout << "find_diameter : " << find_diameter << std::endl;
-	std::uint64_t random_seed = std::random_device{}();
+	std::cout << "coroutine : " << coroutine << std::endl;
+	std::cout << "elide : " << elide << std::endl;
+	std::cout << "prefetch_distance : " << prefetch_distance << std::endl;
+	std::cout << "csr : " << csr << std::endl;
+	std::cout << "implicit : " << implicit << std::endl;
+	std::cout << "reorder : " << reorder_name << std::endl;
+	std::cout << "compressed : " << compressed << std::endl;
+	std::cout << "write_csr : " << write_csr_path << std::endl;
+	std::cout << "changes : " << changes_path << std::endl;
+	std::cout << "edges : " << exact_edges << std::endl;
+	std::cout << "threads : " << num_threads << std::endl;
+	std::cout << "attach : " << edges_per_node << std::endl;
+	std::cout << "radius : " << radius << std::endl;
+	std::cout << "dimensions : " << dimensions << std::endl;
+	std::cout << "degree : " << degree << std::endl;
+	std::cout << "blocks : " << num_blocks << std::endl;
+	std::cout << "inter_block_prob : " << inter_block_prob << std::endl;
+	// R-MAT graphs have 2^scale nodes, enough for num_nodes unless --scale is given
+	std::uint32_t scale = scale_option.value_or(num_nodes > 1 ? std::bit_width(num_nodes - 1) : 0);
+	std::cout << "scale : " << scale << std::endl;
+	std::cout << "edge_factor : " << edge_factor << std::endl;
+	std::cout << "rmat : " << rmat_name << std::endl;
+	std::cout << "connect : " << connect_name << std::endl;
+	std::uint64_t random_seed = seed_option.value_or(std::random_device{}());
 
 	if (synchrony == "a")
 		s = false;
@@ -65,6 +264,232 @@ int main(int argc, char **argv)
 
 	std::default_random_engine random_gen{random_seed};
 
+	// Runs the simulation on the graph, or on a (reordered) CSR, compressed or dynamic copy of it
+	auto run = [&](auto &graph)
+	{
+		using NodeType = std::remove_cvref_t<decltype(graph[0])>;
+		// Generated and loaded CSR graphs are run as they are unless reordered
+		constexpr bool in_csr_form = requires { graph.adjacency(0); };
+		if (!topology_changes.empty())
+		{
+			// The dynamic graph is a CSR already, --reorder relabels the copy it starts from
+			DynamicCsrGraph<NodeType> dynamic_graph = reorder.has_value() ? DynamicCsrGraph<NodeType>{reorderVertices(CsrGraph<NodeType>{graph}, *reorder)} : DynamicCsrGraph<NodeType>{graph};
+			std::cout << "Topology changes scheduled : " << topology_changes.size() << std::endl;
+			runSimulation(dynamic_graph, s, v, time_delay, random_gen(), elide, prefetch_distance, topology_changes);
+		}
+		else if (compressed)
+		{
+			CompressedGraph<NodeType> compressed_graph = reorder.has_value() ? CompressedGraph<NodeType>{reorderVertices(CsrGraph<NodeType>{graph}, *reorder)} : CompressedGraph<NodeType>{graph};
+			std::cout << "Compressed topology size : " << compressed_graph.topology_bytes() << " bytes" << std::endl;
+			std::cout << "Bits per edge : " << compressed_graph.bits_per_edge() << std::endl;
+			runSimulation(compressed_graph, s, v, time_delay, random_gen(), elide, prefetch_distance, topology_changes);
+		}
+		else if (reorder.has_value() || (csr && !in_csr_form))
+		{
+			CsrGraph<NodeType> csr_graph{graph};
+			if (reorder.has_value())
+			{
+				csr_graph = reorderVertices(csr_graph, *reorder);
+			}
+			std::cout << "CSR topology size : " << csr_graph.topology_bytes() << " bytes" << std::endl;
+			runSimulation(csr_graph, s, v, time_delay, random_gen(), elide, prefetch_distance, topology_changes);
+		}
+		else
+		{
+			runSimulation(graph, s, v, time_delay, random_gen(), elide, prefetch_distance, topology_changes);
+		}
+	};
+
+	// file:<path> reads the topology from disk instead of generating it: binary CSR files
+	// (--write-csr) are mapped, edge lists, METIS and Matrix Market files are parsed
+	if (topology.rfind("file:", 0) == 0)
+	{
+		auto run_loaded = [&](auto &graph)
+		{
+			bool any_initiators = false;
+			for (std::uint32_t i = 0; i < graph.num_vertices(); ++i)
+			{
+				any_initiators = any_initiators || graph[i]._initiator;
+			}
+			if (!any_initiators)
+			{
+				chooseInitiators(graph, initiator_prob, random_gen);
+			}
+
+			if (!write_csr_path.empty())
+			{
+				writeCsrFile(write_csr_path, graph);
+				std::cout << "Saved topology to " << write_csr_path << std::endl;
+			}
+
+			if (d)
+			{
+				if constexpr (requires { graph.advise(MappedAccess::Sequential); })
+					graph.advise(MappedAccess::Sequential);
+				auto diameter = measureGraphDiameter(graph);
+				if (!diameter.has_value())
+				{
+					throw std::runtime_error("The graph is not connected.");
+				}
+				std::cout << (topology_changes.empty() ? "Diameter : " : "Initial diameter : ") << *diameter << std::endl;
+				if constexpr (requires { graph.advise(MappedAccess::Random); })
+					graph.advise(MappedAccess::Random);
+			}
+			run(graph);
+		};
+
+		std::string path = topology.substr(5);
+		bool binary = detectGraphFileFormat(path) == GraphFileFormat::Csr;
+		auto load_start = std::chrono::steady_clock::now();
+		auto report_load = [&](const auto &graph)
+		{
+			std::chrono::duration<double> load_time = std::chrono::steady_clock::now() - load_start;
+			std::cout << (binary ? "Mapped " : "Loaded ") << graph.num_vertices() << " nodes and " << graph.num_edges()
+					  << " edges in " << load_time.count() << " s" << std::endl;
+		};
+
+		if (coroutine && binary)
+		{
+			MappedCsrGraph<PelegCoroutineNode> graph{path};
+			report_load(graph);
+			CoroutineFramePool<PelegCoroutineNode>::reserve(graph.num_vertices());
+			run_loaded(graph);
+		}
+		else if (coroutine)
+		{
+			CsrGraph<PelegCoroutineNode> graph = loadGraphFile<PelegCoroutineNode>(path);
+			report_load(graph);
+			CoroutineFramePool<PelegCoroutineNode>::reserve(graph.num_vertices());
+			run_loaded(graph);
+		}
+		else if (binary)
+		{
+			MappedCsrGraph<> graph{path};
+			report_load(graph);
+			run_loaded(graph);
+		}
+		else
+		{
+			CsrGraph<> graph = loadGraphFile(path);
+			report_load(graph);
+			run_loaded(graph);
+		}
+		return 0;
+	}
+
+	// --threads generates the topology straight into CSR form on several threads,
+	// the graph only depends on the seed and not on the number of threads.
+	// Geometric, regular, block model and R-MAT graphs are always generated this way.
+	bool csr_only = topology == "geometric" || topology == "regular" || topology == "sbm" || topology == "rmat";
+	if ((num_threads > 0 || csr_only) && !implicit)
+	{
+		auto run_generated = [&]<typename NodeType>()
+		{
+			std::uint64_t graph_seed = random_gen();
+			auto generation_start = std::chrono::steady_clock::now();
+			// Ring, hypercube and scale-free graphs are connected by construction
+			ConnectivityPolicy policy = topology == "random" || csr_only ? connect_policy : ConnectivityPolicy::Unchecked;
+			CsrGraph<NodeType> graph = generateConnectedCsrGraph(policy, graph_seed, num_threads, [&](std::uint64_t sample_seed)
+			{
+				if (topology == "ring")
+					return generateRingCsrGraph<NodeType>(num_nodes, num_threads);
+				if (topology == "hypercube")
+					return generateHyperCubeCsrGraph<NodeType>(num_nodes, num_threads);
+				if (topology == "random" && exact_edges > 0)
+					return generateRandomCsrGraphWithEdgeCount<NodeType>(num_nodes, exact_edges, sample_seed, num_threads);
+				if (topology == "random")
+					return generateRandomCsrGraph<NodeType>(num_nodes, edge_prob, sample_seed, num_threads);
+				if (topology == "scalefree")
+					return generateScaleFreeCsrGraph<NodeType>(num_nodes, edges_per_node, sample_seed, num_threads);
+				if (topology == "sbm")
+					return generateBlockModelCsrGraph<NodeType>(BlockModel::planted(num_nodes, num_blocks, edge_prob, inter_block_prob), sample_seed, num_threads)._graph;
+				if (topology == "regular")
+					return generateRegularCsrGraph<NodeType>(num_nodes, degree, sample_seed, num_threads);
+				if (topology == "rmat")
+					return generateRmatCsrGraph<NodeType>(scale, edge_factor, sample_seed, rmat_parameters, num_threads);
+				if (topology == "geometric" && dimensions == 2)
+					return generateGeometricGraph<2, NodeType>(num_nodes, radius, sample_seed, num_threads)._graph;
+				if (topology == "geometric" && dimensions == 3)
+					return generateGeometricGraph<3, NodeType>(num_nodes, radius, sample_seed, num_threads)._graph;
+				throw std::runtime_error("No parallel generator for topology : " + topology);
+			});
+			std::chrono::duration<double> generation_time = std::chrono::steady_clock::now() - generation_start;
+			std::cout << "Generated " << graph.num_vertices() << " nodes and " << graph.num_edges() << " edges in "
+					  << generation_time.count() << " s" << std::endl;
+			chooseInitiators(graph, initiator_prob, graph_seed, num_threads);
+
+			if (!write_csr_path.empty())
+			{
+				writeCsrFile(write_csr_path, graph);
+				std::cout << "Saved topology to " << write_csr_path << std::endl;
+			}
+
+			// With --connect none a disconnected graph is saved before the run stops
+			if (policy == ConnectivityPolicy::Unchecked && (topology == "random" || csr_only) && !isConnected(graph))
+			{
+				throw std::runtime_error("The graph is not connected.");
+			}
+			if (d)
+			{
+				auto diameter = measureGraphDiameter(graph);
+				if (!diameter.has_value())
+				{
+					throw std::runtime_error("The graph is not connected.");
+				}
+				std::cout << (topology_changes.empty() ? "Diameter : " : "Initial diameter : ") << *diameter << std::endl;
+			}
+			if constexpr (std::is_same_v<NodeType, PelegCoroutineNode>)
+				CoroutineFramePool<PelegCoroutineNode>::reserve(graph.num_vertices());
+			run(graph);
+		};
+
+		if (coroutine)
+			run_generated.template operator()<PelegCoroutineNode>();
+		else
+			run_generated.template operator()<Node>();
+		return 0;
+	}
+
+	// Implicit topologies compute neighbors on the fly, the simulation runs on them directly
+	if (implicit)
+	{
+		auto run_implicit = [&](auto graph)
+		{
+			if (topology == "random" && !isConnected(graph))
+			{
+				throw std::runtime_error("The graph is not connected.");
+			}
+			if (d)
+			{
+				auto diameter = measureGraphDiameter(graph);
+				if (!diameter.has_value())
+				{
+					throw std::runtime_error("The graph is not connected.");
+				}
+				std::cout << "Diameter : " << *diameter << std::endl;
+			}
+			runSimulation(graph, s, v, time_delay, random_gen(), elide, prefetch_distance, topology_changes);
+		};
+
+		std::cout << "Using implicit " << topology << " topology" << std::endl;
+		if (topology == "ring")
+			run_implicit(generateImplicitGraph(RingTopology{num_nodes}, initiator_prob, random_gen));
+		else if (topology == "line")
+			run_implicit(generateImplicitGraph(LineTopology{num_nodes}, initiator_prob, random_gen));
+		else if (topology == "hypercube")
+			run_implicit(generateImplicitGraph(HyperCubeTopology{num_nodes}, initiator_prob, random_gen));
+		else if (topology == "complete")
+			run_implicit(generateImplicitGraph(CompleteTopology{num_nodes}, initiator_prob, random_gen));
+		else if (topology == "random")
+			run_implicit(generateHashedRandomGraph(num_nodes, initiator_prob, edge_prob, random_gen));
+		else
+		{
+			std::cerr << "No implicit version of topology : " << topology << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
 	Graph g;
 
 	if (topology == "ring")
@@ -87,7 +512,11 @@ int main(int argc, char **argv)
 				  << "Synchronous : " << s << std::endl
 				  << "Mean time delay : " << time_delay << std::endl
 				  << std::endl;
-		g = generateRandomGraph(num_nodes, initiator_prob, edge_prob, random_gen);
+		// --edges switches from G(n, p) to G(n, m)
+		if (exact_edges > 0)
+			g = generateRandomGraphWithEdgeCount(num_nodes, initiator_prob, exact_edges, random_gen, connect_policy);
+		else
+			g = generateRandomGraph(num_nodes, initiator_prob, edge_prob, random_gen, connect_policy);
 	}
 	else if (topology == "hypercube")
 	{
@@ -100,36 +529,47 @@ int main(int argc, char **argv)
 				  << std::endl;
 		g = generateHyperCubeGraph(num_nodes, initiator_prob, random_gen);
 	}
+	else if (topology == "scalefree")
+	{
+		std::cout << "Generating Scale-free Graph " << std::endl
+				  << "No. of nodes :" << num_nodes << std::endl
+				  << "Initiator probability : " << initiator_prob << std::endl
+				  << "Edges per new node : " << edges_per_node << std::endl
+				  << "Synchronous : " << s << std::endl
+				  << "Mean time delay : " << time_delay << std::endl
+				  << std::endl;
+		g = generateScaleFreeGraph(num_nodes, edges_per_node, initiator_prob, random_gen);
+	}
 
-	if (d == true || topology == "random")
+	// random graphs are connected by construction unless --connect none
+	if (topology == "random" && connect_policy == ConnectivityPolicy::Unchecked && !isConnected(g))
+	{
+		throw std::runtime_error("The graph is not connected.");
+	}
+	if (d == true)
 	{
 		auto diameter = measureGraphDiameter(g);
-		if (diameter.has_value())
-		{
-			std::cout << "Diameter: " << *diameter << std::endl;
-		}
-		else
+		if (!diameter.has_value())
 		{
 			throw std::runtime_error("The graph is not connected.");
 		}
-		std::cout << "Diameter : " << *diameter << std::endl;
+		// --changes edits the topology during the run, the value is the one of the initial graph
+		std::cout << (topology_changes.empty() ? "Diameter : " : "Initial diameter : ") << *diameter << std::endl;
 	}
 
-	using TimeType = std::uint32_t;
-	AsyncSimulation simulation{g, std::poisson_distribution<TimeType>{time_delay}, random_gen(), s, v};
-	simulation.run();
+	if (!write_csr_path.empty())
+	{
+		writeCsrFile(write_csr_path, g);
+		std::cout << "Saved topology to " << write_csr_path << std::endl;
+	}
 
-	if (d)
+	if (coroutine)
 	{
-		auto diameter = measureGraphDiameter(g);
-		if (diameter.has_value())
-		{
-			std::cout << "Diameter: " << *diameter << std::endl;
-		}
-		else
-		{
-			throw std::runtime_error("The graph is not connected.");
-		}
-		std::cout << "Diameter : " << *diameter << std::endl;
+		CoroutineGraph coroutine_graph = makeCoroutineGraph(g);
+		run(coroutine_graph);
+	}
+	else
+	{
+		run(g);
 	}
 }
\ No newline at end of file
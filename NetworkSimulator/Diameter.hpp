@@ -1,56 +1,333 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <vector>
 
-#include "Eigen/Dense"
-
 #include "Node.hpp"
+#include "BitMatrix.hpp"
+#include "Connectivity.hpp"
+#include "Parallel.hpp"
+
+// Eccentricity of every node (its largest distance to another node), their maximum and their minimum
+struct Eccentricities
+{
+    std::vector<std::uint32_t> _eccentricities;
+    std::uint32_t _diameter = 0;
+    std::uint32_t _radius = 0;
+};
+
+// Exact eccentricities of a connected graph by a breadth-first search from every node, or nullopt if
+// the graph is not connected. The searches run in batches of 64 * Words sources (MS-BFS, Then et al.,
+// "The More the Merrier", 2014): every node keeps one bit per source of the batch for "seen" and for
+// "in the frontier", so one pass over a neighbor list advances all the searches that reach it at the
+// same level. Nodes of a batch are consecutive ids, which tend to share frontiers. Batches are handed
+// out to num_threads threads, each with its own bit arrays (3 * 8 * Words bytes per node). The threads
+// call adjacent_vertices on g concurrently, which the simulator graphs allow (HashedRandomGraph decodes
+// into a cache per thread), a graph type with shared mutable state needs num_threads = 1.
+template <std::size_t Words = 4, typename GraphType>
+std::optional<Eccentricities> measureEccentricities(const GraphType &g, std::uint32_t num_threads = 0)
+{
+    using SourceBits = std::array<std::uint64_t, Words>;
+    constexpr std::uint32_t batch_size = 64 * Words;
+
+    if (!isConnected(g))
+    {
+        return std::nullopt;
+    }
+    const std::uint32_t n = num_vertices(g);
+    Eccentricities result{std::vector<std::uint32_t>(n, 0), 0, 0};
+    if (n == 0)
+    {
+        return result;
+    }
+
+    const std::uint32_t num_batches = (static_cast<std::uint64_t>(n) + batch_size - 1) / batch_size;
+    std::atomic<std::uint32_t> next_batch{0};
+    if (num_threads == 0)
+    {
+        num_threads = defaultThreadCount();
+    }
+    parallelFor(0, std::min(num_threads, num_batches), num_threads, [&](std::uint32_t, std::uint64_t, std::uint64_t)
+                {
+                    std::vector<SourceBits> seen(n), frontier(n), next(n);
+                    std::vector<std::uint32_t> active, next_active;
+                    for (std::uint32_t batch; (batch = next_batch++) < num_batches;)
+                    {
+                        const std::uint32_t first = batch * batch_size;
+                        const std::uint32_t count = std::min(batch_size, n - first);
+                        std::fill(seen.begin(), seen.end(), SourceBits{});
+                        active.clear();
+                        for (std::uint32_t i = 0; i < count; ++i)
+                        {
+                            seen[first + i][i / 64] |= std::uint64_t{1} << (i % 64);
+                            frontier[first + i] = seen[first + i];
+                            active.push_back(first + i);
+                        }
+
+                        for (std::uint32_t level = 1; !active.empty(); ++level)
+                        {
+                            next_active.clear();
+                            for (std::uint32_t v : active)
+                            {
+                                const SourceBits &reaching = frontier[v];
+                                auto [begin, end] = adjacent_vertices(v, g);
+                                for (auto it = begin; it != end; ++it)
+                                {
+                                    SourceBits &seen_by = seen[*it];
+                                    SourceBits fresh;
+                                    std::uint64_t any_fresh = 0;
+                                    for (std::size_t k = 0; k < Words; ++k)
+                                    {
+                                        fresh[k] = reaching[k] & ~seen_by[k];
+                                        any_fresh |= fresh[k];
+                                    }
+                                    if (any_fresh == 0)
+                                    {
+                                        continue;
+                                    }
+                                    SourceBits &next_bits = next[*it];
+                                    std::uint64_t any_next = 0;
+                                    for (std::size_t k = 0; k < Words; ++k)
+                                    {
+                                        any_next |= next_bits[k];
+                                        next_bits[k] |= fresh[k];
+                                        seen_by[k] |= fresh[k];
+                                    }
+                                    if (any_next == 0)
+                                    {
+                                        next_active.push_back(*it);
+                                    }
+                                }
+                            }
+
+                            // The sources still reaching new nodes are at least level away from them
+                            SourceBits reached{};
+                            for (std::uint32_t v : next_active)
+                            {
+                                for (std::size_t k = 0; k < Words; ++k)
+                                {
+                                    reached[k] |= next[v][k];
+                                }
+                            }
+                            for (std::size_t k = 0; k < Words; ++k)
+                            {
+                                for (std::uint64_t bits = reached[k]; bits != 0; bits &= bits - 1)
+                                {
+                                    result._eccentricities[first + 64 * k + std::countr_zero(bits)] = level;
+                                }
+                            }
+
+                            for (std::uint32_t v : active)
+                            {
+                                frontier[v] = SourceBits{};
+                            }
+                            std::swap(frontier, next);
+                            std::swap(active, next_active);
+                        }
+                    } });
+
+    result._diameter = *std::max_element(result._eccentricities.begin(), result._eccentricities.end());
+    result._radius = *std::min_element(result._eccentricities.begin(), result._eccentricities.end());
+    return result;
+}
+
+// Bounds on the diameter found by measureDiameterIfub, and the number of breadth-first searches used
+struct DiameterBounds
+{
+    std::uint32_t _lower_bound = 0;
+    std::uint32_t _upper_bound = 0;
+    std::uint64_t _bfs_runs = 0;
+
+    bool exact() const { return _lower_bound == _upper_bound; }
+};
+
+namespace detail
+{
+    constexpr std::uint32_t unreached = std::numeric_limits<std::uint32_t>::max();
+
+    // Breadth-first search from source, fills distances and returns the eccentricity of source.
+    // queue ends up holding the nodes reached, by increasing distance.
+    template <typename GraphType>
+    std::uint32_t bfsDistances(const GraphType &g, std::uint32_t source, std::vector<std::uint32_t> &distances, std::vector<std::uint32_t> &queue)
+    {
+        std::fill(distances.begin(), distances.end(), unreached);
+        queue.clear();
+        queue.push_back(source);
+        distances[source] = 0;
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            const std::uint32_t v = queue[head];
+            auto [begin, end] = adjacent_vertices(v, g);
+            for (auto it = begin; it != end; ++it)
+            {
+                if (distances[*it] == unreached)
+                {
+                    distances[*it] = distances[v] + 1;
+                    queue.push_back(*it);
+                }
+            }
+        }
+        return distances[queue.back()];
+    }
 
-std::optional<std::uint64_t> measureGraphDiameter(const Graph& g)
+    // Node halfway along a shortest path from the source of distances to target
+    template <typename GraphType>
+    std::uint32_t pathMiddle(const GraphType &g, const std::vector<std::uint32_t> &distances, std::uint32_t target)
+    {
+        const std::uint32_t middle = distances[target] / 2;
+        while (distances[target] > middle)
+        {
+            auto [begin, end] = adjacent_vertices(target, g);
+            target = *std::find_if(begin, end, [&](std::uint32_t neighbor)
+                                   { return distances[neighbor] + 1 == distances[target]; });
+        }
+        return target;
+    }
+}
+
+// Exact diameter of a large sparse graph with usually a handful of breadth-first searches, with iFUB
+// (Crescenzi et al., "On computing the diameter of real-world undirected graphs", 2013). A 4-sweep picks
+// a central node u and a lower bound: two double sweeps (the farthest node a from a start, the farthest
+// node b from a) starting from the highest degree node, then from the middle of the first a-b path; u is
+// the middle of the second. Then the levels of the search from u are visited from the farthest: a node
+// at distance i from u has eccentricity at most 2i, so once the largest eccentricity found exceeds twice
+// the next level, it is the diameter. Stops after max_bfs_runs searches (e.g. on rings, where every level
+// is needed) with the bounds found so far, which are then not exact. Returns nullopt if the graph is
+// not connected.
+template <typename GraphType>
+std::optional<DiameterBounds> measureDiameterIfub(const GraphType &g, std::uint64_t max_bfs_runs = std::numeric_limits<std::uint64_t>::max())
 {
-    using AdjacencyMatrix = Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>;
+    const std::uint32_t n = num_vertices(g);
+    DiameterBounds bounds;
+    if (n <= 1)
+    {
+        return bounds;
+    }
+
+    std::vector<std::uint32_t> distances(n);
+    std::vector<std::uint32_t> queue;
+    queue.reserve(n);
+    auto bfs = [&](std::uint32_t source)
+    {
+        ++bounds._bfs_runs;
+        return detail::bfsDistances(g, source, distances, queue);
+    };
 
-    const auto num_vertices = boost::num_vertices(g);
-    std::vector<AdjacencyMatrix> memoized_matrices;
+    std::uint32_t start = 0;
+    std::uint64_t start_degree = 0;
+    for (std::uint32_t v = 0; v < n; ++v)
+    {
+        auto [begin, end] = adjacent_vertices(v, g);
+        const std::uint64_t degree = std::distance(begin, end);
+        if (degree > start_degree)
+        {
+            start = v;
+            start_degree = degree;
+        }
+    }
+
+    // 4-sweep
+    bfs(start);
+    if (queue.size() != n)
+    {
+        return std::nullopt;
+    }
+    for (std::uint32_t sweep = 0; sweep < 2; ++sweep)
+    {
+        const std::uint32_t a = queue.back();
+        bounds._lower_bound = std::max(bounds._lower_bound, bfs(a));
+        start = detail::pathMiddle(g, distances, queue.back());
+        if (sweep == 0)
+        {
+            bfs(start);
+        }
+    }
+
+    const std::uint32_t center = start;
+    std::uint32_t level = bfs(center);
+    bounds._lower_bound = std::max(bounds._lower_bound, level);
+    bounds._upper_bound = 2 * level;
+    // Nodes of the search from the center by decreasing distance, the search buffers get reused below
+    std::vector<std::uint32_t> by_distance(queue.rbegin(), queue.rend());
+    std::vector<std::uint32_t> center_distances = distances;
+
+    std::size_t next = 0;
+    while (bounds._upper_bound > bounds._lower_bound)
+    {
+        // Every node farther than level from the center has been searched from, so the diameter is
+        // either a path between two of them (found) or at most twice level
+        for (; next < by_distance.size() && center_distances[by_distance[next]] == level; ++next)
+        {
+            if (bounds._bfs_runs == max_bfs_runs)
+            {
+                return bounds;
+            }
+            bounds._lower_bound = std::max(bounds._lower_bound, bfs(by_distance[next]));
+        }
+        if (level == 0 || bounds._lower_bound > 2 * (level - 1))
+        {
+            bounds._upper_bound = bounds._lower_bound;
+            break;
+        }
+        bounds._upper_bound = 2 * (level - 1);
+        --level;
+    }
+    return bounds;
+}
 
-    // Build the adjacency matrix
-    memoized_matrices.emplace_back(AdjacencyMatrix::Identity(num_vertices, num_vertices));
+// Diameter from powers of the adjacency matrix, nullopt if the graph is not connected. The matrices are
+// bit-packed and multiplied on num_threads threads, O(n^3 / 64 log^2 D) word operations. Only a few
+// matrices are alive at a time: the powers needed by the binary search are squared again from the
+// adjacency matrix when needed rather than kept from the first pass, so memory is O(n^2 / 8) bytes
+// instead of O(n^2 log D).
+template <typename GraphType>
+std::optional<std::uint64_t> measureGraphDiameterWithMatrices(const GraphType& g, std::uint32_t num_threads = 0)
+{
+    const std::uint32_t vertex_count = num_vertices(g);
 
-    auto [vertices_begin, vertices_end] = boost::vertices(g);
+    // Build the adjacency matrix, with the diagonal: the nodes within distance 1 of each other
+    BitMatrix adjacency = BitMatrix::identity(vertex_count);
+    auto [vertices_begin, vertices_end] = vertices(g);
     for (auto it = vertices_begin; it != vertices_end; ++it)
     {
         auto vertex_descriptor = *it;
-        auto [out_begin, out_end] = boost::adjacent_vertices(vertex_descriptor, g);
+        auto [out_begin, out_end] = adjacent_vertices(vertex_descriptor, g);
 
         for (auto other_it = out_begin; other_it != out_end; ++other_it)
         {
-            memoized_matrices[0](vertex_descriptor, *other_it) = 1;
+            adjacency.set(vertex_descriptor, *other_it);
         }
     }
 
-    if (memoized_matrices.back().all()) {
+    if (adjacency.all()) {
         // Complete graph
         return 1;
     }
 
-    // Calculate adjacency_matrix adj^(2^k) where adj is the adjacency matrix
-    // and k is high enough that adj becomes all 1s
-    while (!memoized_matrices.back().all()) {
-        const auto& new_mat = memoized_matrices.emplace_back(memoized_matrices.back() * memoized_matrices.back());
-
-        auto vec_end = memoized_matrices.end();
-        if (*(vec_end - 1) == *(vec_end - 2)) {
+    // adj^(2^k) where k is high enough that it becomes all 1s, keeping adj^(2^(k - 1))
+    std::uint64_t log_diameter_upper_bound = 0;
+    BitMatrix reached = adjacency;
+    BitMatrix power = adjacency;
+    while (!power.all()) {
+        BitMatrix squared = multiply(power, power, num_threads);
+        if (squared == power) {
             // The matrix reached a steady state but it's not all 1s
             // this means the graph is not connected
             return std::nullopt;
         }
+        reached = std::move(power);
+        power = std::move(squared);
+        ++log_diameter_upper_bound;
     }
 
-    std::uint64_t log_diameter_upper_bound = memoized_matrices.size() - 1;
     std::uint64_t diameter_upper_bound = 1 << log_diameter_upper_bound;
     std::uint64_t diameter_lower_bound = (1 << (log_diameter_upper_bound - 1)) + 1;
-    // Matrix of all 1s not needed anymore
-    memoized_matrices.pop_back();
 
     // Binary search for the first exponent that makes the matrix all 1s
     // between 2^(k - 1) and 2^k
@@ -60,11 +337,15 @@ std::optional<std::uint64_t> measureGraphDiameter(const Graph& g)
             throw std::runtime_error("Bounds met too quickly.");
         }
 
-        AdjacencyMatrix mat = memoized_matrices.back() * memoized_matrices[i];
+        power = adjacency;
+        for (std::uint64_t j = 0; j < i; ++j) {
+            power = multiply(power, power, num_threads);
+        }
+        BitMatrix mat = multiply(reached, power, num_threads);
 
         if (!mat.all()) {
-            // the current exponent is not high enough to make adj all 1s, keep the 2^(k - i) factor
-            memoized_matrices.back() = mat;
+            // the current exponent is not high enough to make adj all 1s, keep the 2^i factor
+            reached = std::move(mat);
             diameter_lower_bound += (1 << i);
         }
         else {
@@ -78,4 +359,41 @@ std::optional<std::uint64_t> measureGraphDiameter(const Graph& g)
     }
 
     return diameter_lower_bound;
-}
\ No newline at end of file
+}
+
+// GraphType is a Graph or any graph type with the same free functions, e.g. CsrGraph, whose
+// adjacent_vertices can be called from several threads at once (see measureEccentricities).
+// Sparse graphs, with fewer than n / 64 neighbors per node on average, go through iFUB, and through
+// the breadth-first searches of measureEccentricities, which cost O(n m / 256) word operations, when
+// iFUB needs too many searches. Denser graphs use the matrix products.
+template <typename GraphType>
+std::optional<std::uint64_t> measureGraphDiameter(const GraphType& g)
+{
+    const std::uint64_t n = num_vertices(g);
+    std::uint64_t endpoints = 0;
+    for (std::uint32_t v = 0; v < n; ++v)
+    {
+        auto [begin, end] = adjacent_vertices(v, g);
+        endpoints += std::distance(begin, end);
+    }
+    if (endpoints < n * n / 64)
+    {
+        // iFUB gives up once it has used about as many searches as the batched searches over all nodes take
+        auto bounds = measureDiameterIfub(g, std::max<std::uint64_t>(64, n / 64));
+        if (!bounds.has_value())
+        {
+            return std::nullopt;
+        }
+        if (bounds->exact())
+        {
+            return bounds->_lower_bound;
+        }
+        auto eccentricities = measureEccentricities(g);
+        if (!eccentricities.has_value())
+        {
+            return std::nullopt;
+        }
+        return eccentricities->_diameter;
+    }
+    return measureGraphDiameterWithMatrices(g);
+}
@@ -1,4 +1,5 @@
 #include "Diameter.hpp"
+#include "Connectivity.hpp"
 
 #include "GraphGen.hpp"
 
@@ -11,6 +12,76 @@ TEST_P(DiameterTest, ComputeDiameter) {
     ASSERT_EQ(measureGraphDiameter(graph), diameter);
 }
 
+TEST_P(DiameterTest, ComputeEccentricities) {
+    auto [diameter, graph, name] = GetParam();
+    auto eccentricities = measureEccentricities(graph);
+    ASSERT_EQ(eccentricities.has_value(), diameter.has_value());
+    if (!diameter) {
+        return;
+    }
+    ASSERT_EQ(eccentricities->_diameter, *diameter);
+    ASSERT_LE(eccentricities->_radius, *diameter);
+    ASSERT_GE(2 * eccentricities->_radius, *diameter);
+}
+
+TEST_P(DiameterTest, MatrixMethodAgrees) {
+    auto [diameter, graph, name] = GetParam();
+    ASSERT_EQ(measureGraphDiameterWithMatrices(graph), diameter);
+}
+
+TEST_P(DiameterTest, IfubAgreesWithMatrixMethod) {
+    auto [diameter, graph, name] = GetParam();
+    auto bounds = measureDiameterIfub(graph);
+    ASSERT_TRUE(bounds.has_value());
+    ASSERT_TRUE(bounds->exact());
+    ASSERT_EQ(bounds->_lower_bound, measureGraphDiameterWithMatrices(graph));
+    ASSERT_LE(bounds->_bfs_runs, boost::num_vertices(graph) + 5);
+}
+
+TEST_P(DiameterTest, ConnectedIffDiameterExists) {
+    auto [diameter, graph, name] = GetParam();
+    ASSERT_EQ(isConnected(graph), diameter.has_value());
+    ASSERT_EQ(labelComponents(graph)._num_components == 1, diameter.has_value());
+}
+
+TEST(EccentricityTest, RingNodesAllHaveHalfTheLength) {
+    for (std::uint32_t n : {300, 301}) {
+        auto eccentricities = measureEccentricities(generateRingGraph(n), 2);
+        ASSERT_TRUE(eccentricities.has_value());
+        ASSERT_EQ(eccentricities->_eccentricities, std::vector<std::uint32_t>(n, n / 2));
+        ASSERT_EQ(eccentricities->_radius, n / 2);
+    }
+}
+
+// Paths with random chords, connected and with diameters spread between 1 and n - 1
+TEST(IfubTest, AgreesWithMatrixMethodOnRandomGraphs) {
+    std::default_random_engine random_gen{7};
+    for (std::uint32_t n : {3, 20, 60, 150}) {
+        for (double p : {0.005, 0.02, 0.1, 0.5}) {
+            Graph graph = generateLineGraph(n);
+            forEachRandomEdge(n, p, random_gen, [&](std::uint32_t u, std::uint32_t v) {
+                if (v != u + 1) {
+                    boost::add_edge(u, v, graph);
+                }
+            });
+            auto diameter = measureGraphDiameterWithMatrices(graph);
+            auto bounds = measureDiameterIfub(graph);
+            ASSERT_TRUE(bounds->exact());
+            ASSERT_EQ(bounds->_lower_bound, diameter) << "n = " << n << ", p = " << p;
+            ASSERT_EQ(measureEccentricities(graph)->_diameter, diameter);
+        }
+    }
+}
+
+TEST(IfubTest, StopsWithBoundsAfterMaxSearches) {
+    Graph graph = generateRingGraph(200);
+    auto bounds = measureDiameterIfub(graph, 10);
+    ASSERT_EQ(bounds->_bfs_runs, 10);
+    ASSERT_LE(bounds->_lower_bound, 100);
+    ASSERT_GE(bounds->_upper_bound, 100);
+    ASSERT_EQ(measureGraphDiameter(graph), 100);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     DiameterTests,
     DiameterTest,
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+
+// Edge insertion (_insert) or deletion between the nodes with ids _u and _v, at simulation time _time
+template <typename TimeType>
+struct TopologyChange
+{
+    TimeType _time;
+    std::uint32_t _u;
+    std::uint32_t _v;
+    bool _insert;
+};
+
+// Reads a schedule of topology changes, one "<time> <+ or -> <u> <v>" per line, '#' starts a comment.
+// The changes are returned sorted by time, changes with the same time keep their file order.
+template <typename TimeType = std::uint32_t>
+std::vector<TopologyChange<TimeType>> readTopologyChanges(const std::string &path)
+{
+    std::ifstream in{path};
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open " + path + ".");
+    }
+
+    std::vector<TopologyChange<TimeType>> changes;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields{line};
+        TimeType time;
+        std::string kind;
+        std::uint32_t u, v;
+        if (!(fields >> time))
+        {
+            continue;
+        }
+        if (!(fields >> kind >> u >> v) || (kind != "+" && kind != "-"))
+        {
+            throw std::runtime_error("Malformed topology change in " + path + " : " + line);
+        }
+        changes.push_back(TopologyChange<TimeType>{time, u, v, kind == "+"});
+    }
+
+    std::stable_sort(changes.begin(), changes.end(), [](const auto &a, const auto &b)
+                     { return a._time < b._time; });
+    return changes;
+}
+
+// Undirected graph in CSR form with slack at the end of every neighbor list, so edges can be
+// inserted and deleted while the simulation runs:
+// - deleting moves the last neighbor into the freed slot, O(degree)
+// - inserting appends into the slack, a full list moves to the end of the array with twice
+//   the capacity. The array is compacted once more than half of it is abandoned lists,
+//   which keeps insertions amortized O(degree).
+// Neighbor lists are unordered. Vertex descriptors are indices in [0, num_vertices).
+template <typename NodeType = Node>
+class DynamicCsrGraph
+{
+public:
+    using vertex_descriptor = std::uint32_t;
+    using edge_descriptor = std::pair<std::uint32_t, std::uint32_t>;
+    using adjacency_iterator = const std::uint32_t *;
+    using vertex_iterator = boost::counting_iterator<std::uint32_t>;
+    using directed_category = boost::undirected_tag;
+    using edge_parallel_category = boost::disallow_parallel_edge_tag;
+    using traversal_category = AdjacencyTraversalTag;
+    using vertices_size_type = std::uint32_t;
+    using edges_size_type = std::uint64_t;
+    using degree_size_type = std::uint32_t;
+    using vertex_bundled = NodeType;
+
+    // Copies any graph with vertex indices in [0, num_vertices) (e.g. Graph or CsrGraph) and its
+    // node states. Every vertex gets slack * degree free slots, and at least min_slack.
+    template <typename SourceGraph>
+    explicit DynamicCsrGraph(const SourceGraph &g, double slack = 0.25, std::uint32_t min_slack = 2)
+        : _slack{slack}, _min_slack{min_slack}
+    {
+        // The member functions would hide the free ones, which are found through the source graph type
+        using boost::adjacent_vertices;
+        using boost::num_vertices;
+
+        const std::uint32_t n = num_vertices(g);
+        _starts.resize(n);
+        _degrees.resize(n);
+        _capacities.resize(n);
+        _nodes.reserve(n);
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            auto [begin, end] = adjacent_vertices(v, g);
+            _starts[v] = _neighbors.size();
+            _neighbors.insert(_neighbors.end(), begin, end);
+            _degrees[v] = _neighbors.size() - _starts[v];
+            _capacities[v] = capacity_for(_degrees[v]);
+            _neighbors.resize(_starts[v] + _capacities[v]);
+            _num_edges += _degrees[v];
+            _nodes.push_back(g[v]);
+        }
+        _num_edges /= 2;
+    }
+
+    std::uint32_t num_vertices() const { return _nodes.size(); }
+    std::uint64_t num_edges() const { return _num_edges; }
+    std::uint32_t degree(std::uint32_t v) const { return _degrees[v]; }
+
+    // Invalidated by insert_edge, not by remove_edge
+    std::pair<adjacency_iterator, adjacency_iterator> adjacency(std::uint32_t v) const
+    {
+        const std::uint32_t *row = _neighbors.data() + _starts[v];
+        return {row, row + _degrees[v]};
+    }
+
+    bool has_edge(std::uint32_t u, std::uint32_t v) const
+    {
+        // Scanning the shorter list is enough in an undirected graph
+        if (_degrees[v] < _degrees[u])
+        {
+            std::swap(u, v);
+        }
+        auto [begin, end] = adjacency(u);
+        return std::find(begin, end, v) != end;
+    }
+
+    // Returns false if the edge already exists or is a self loop
+    bool insert_edge(std::uint32_t u, std::uint32_t v)
+    {
+        if (u == v || has_edge(u, v))
+        {
+            return false;
+        }
+        append(u, v);
+        append(v, u);
+        ++_num_edges;
+        return true;
+    }
+
+    // Returns false if there is no such edge
+    bool remove_edge(std::uint32_t u, std::uint32_t v)
+    {
+        if (!erase(u, v))
+        {
+            return false;
+        }
+        erase(v, u);
+        --_num_edges;
+        return true;
+    }
+
+    NodeType &operator[](std::uint32_t v) { return _nodes[v]; }
+    const NodeType &operator[](std::uint32_t v) const { return _nodes[v]; }
+    const NodeType *node_data() const { return _nodes.data(); }
+
+    // Bytes used by the topology, including slack and abandoned lists
+    std::uint64_t topology_bytes() const
+    {
+        return _starts.capacity() * sizeof(std::uint64_t) + (_degrees.capacity() + _capacities.capacity() + _neighbors.capacity()) * sizeof(std::uint32_t);
+    }
+
+private:
+    std::uint32_t capacity_for(std::uint32_t degree) const
+    {
+        return degree + std::max(_min_slack, static_cast<std::uint32_t>(degree * _slack));
+    }
+
+    void append(std::uint32_t v, std::uint32_t neighbor)
+    {
+        if (_degrees[v] == _capacities[v])
+        {
+            // Moves the list to the end of the array with room to grow
+            std::uint32_t capacity = std::max(2 * _capacities[v], capacity_for(_degrees[v] + 1));
+            std::uint64_t start = _neighbors.size();
+            _neighbors.resize(start + capacity);
+            std::copy_n(_neighbors.begin() + _starts[v], _degrees[v], _neighbors.begin() + start);
+            _abandoned_slots += _capacities[v];
+            _starts[v] = start;
+            _capacities[v] = capacity;
+        }
+        _neighbors[_starts[v] + _degrees[v]++] = neighbor;
+
+        if (_abandoned_slots > _neighbors.size() / 2)
+        {
+            compact();
+        }
+    }
+
+    bool erase(std::uint32_t v, std::uint32_t neighbor)
+    {
+        std::uint32_t *row = _neighbors.data() + _starts[v];
+        std::uint32_t *slot = std::find(row, row + _degrees[v], neighbor);
+        if (slot == row + _degrees[v])
+        {
+            return false;
+        }
+        *slot = row[--_degrees[v]];
+        return true;
+    }
+
+    void compact()
+    {
+        std::vector<std::uint32_t> neighbors;
+        neighbors.reserve(_neighbors.size() - _abandoned_slots);
+        for (std::uint32_t v = 0; v < num_vertices(); ++v)
+        {
+            std::uint64_t start = neighbors.size();
+            neighbors.insert(neighbors.end(), _neighbors.begin() + _starts[v], _neighbors.begin() + _starts[v] + _degrees[v]);
+            _capacities[v] = std::max(_capacities[v], capacity_for(_degrees[v]));
+            neighbors.resize(start + _capacities[v]);
+            _starts[v] = start;
+        }
+        _neighbors = std::move(neighbors);
+        _abandoned_slots = 0;
+    }
+
+    double _slack;
+    std::uint32_t _min_slack;
+    std::vector<std::uint64_t> _starts{};
+    std::vector<std::uint32_t> _degrees{};
+    std::vector<std::uint32_t> _capacities{};
+    std::vector<std::uint32_t> _neighbors{};
+    std::uint64_t _abandoned_slots = 0;
+    std::uint64_t _num_edges = 0;
+    std::vector<NodeType> _nodes{};
+};
+
+template <typename NodeType>
+std::pair<boost::counting_iterator<std::uint32_t>, boost::counting_iterator<std::uint32_t>> vertices(const DynamicCsrGraph<NodeType> &g)
+{
+    return {0, g.num_vertices()};
+}
+
+template <typename NodeType>
+std::uint32_t num_vertices(const DynamicCsrGraph<NodeType> &g)
+{
+    return g.num_vertices();
+}
+
+template <typename NodeType>
+std::uint64_t num_edges(const DynamicCsrGraph<NodeType> &g)
+{
+    return g.num_edges();
+}
+
+template <typename NodeType>
+std::pair<const std::uint32_t *, const std::uint32_t *> adjacent_vertices(std::uint32_t v, const DynamicCsrGraph<NodeType> &g)
+{
+    return g.adjacency(v);
+}
+
+template <typename NodeType>
+std::uint32_t out_degree(std::uint32_t v, const DynamicCsrGraph<NodeType> &g)
+{
+    return g.degree(v);
+}
+
+// edge, add_edge and remove_edge follow the boost signatures, so AsyncSimulation applies
+// topology changes the same way to a DynamicCsrGraph and to an adjacency_list
+template <typename NodeType>
+std::pair<std::pair<std::uint32_t, std::uint32_t>, bool> edge(std::uint32_t u, std::uint32_t v, const DynamicCsrGraph<NodeType> &g)
+{
+    return {{u, v}, g.has_edge(u, v)};
+}
+
+template <typename NodeType>
+std::pair<std::pair<std::uint32_t, std::uint32_t>, bool> add_edge(std::uint32_t u, std::uint32_t v, DynamicCsrGraph<NodeType> &g)
+{
+    return {{u, v}, g.insert_edge(u, v)};
+}
+
+template <typename NodeType>
+void remove_edge(std::uint32_t u, std::uint32_t v, DynamicCsrGraph<NodeType> &g)
+{
+    g.remove_edge(u, v);
+}
+
+template <typename NodeType, typename Member, typename T>
+NodeMemberMap<NodeType, T> get(T Member::*member, const DynamicCsrGraph<NodeType> &g)
+{
+    return {g.node_data(), member};
+}
+
+template <typename NodeType>
+void prefetchAdjacency(std::uint32_t v, const DynamicCsrGraph<NodeType> &g)
+{
+    prefetch(g.adjacency(v).first);
+}
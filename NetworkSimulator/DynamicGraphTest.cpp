@@ -0,0 +1,172 @@
+#include "DynamicGraph.hpp"
+#include "AsyncSimulation.hpp"
+#include "CoroutineNode.hpp"
+
+#include "GraphGen.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <typename GraphType>
+std::set<std::uint32_t> neighborsOf(const GraphType &graph, std::uint32_t v) {
+    auto [begin, end] = graph.adjacency(v);
+    return {begin, end};
+}
+
+}
+
+TEST(DynamicGraphTest, CopiesTheSourceGraph) {
+    DynamicCsrGraph<> graph{generateRingGraph(5)};
+    ASSERT_EQ(graph.num_vertices(), 5);
+    ASSERT_EQ(graph.num_edges(), 5);
+    ASSERT_EQ(neighborsOf(graph, 0), (std::set<std::uint32_t>{1, 4}));
+    ASSERT_EQ(graph[3]._id, 3);
+}
+
+TEST(DynamicGraphTest, InsertsAndRemovesEdges) {
+    DynamicCsrGraph<> graph{generateLineGraph(4)};
+    ASSERT_FALSE(graph.insert_edge(0, 1));
+    ASSERT_FALSE(graph.insert_edge(2, 2));
+    ASSERT_TRUE(graph.insert_edge(3, 0));
+    ASSERT_TRUE(graph.has_edge(0, 3));
+    ASSERT_EQ(graph.num_edges(), 4);
+
+    ASSERT_FALSE(graph.remove_edge(0, 2));
+    ASSERT_TRUE(graph.remove_edge(2, 1));
+    ASSERT_FALSE(graph.has_edge(1, 2));
+    ASSERT_EQ(graph.num_edges(), 3);
+    ASSERT_EQ(neighborsOf(graph, 1), (std::set<std::uint32_t>{0}));
+    ASSERT_EQ(neighborsOf(graph, 2), (std::set<std::uint32_t>{3}));
+}
+
+// Enough insertions to move full lists and compact the array many times, checked against sets
+TEST(DynamicGraphTest, MatchesReferenceThroughMovesAndCompactions) {
+    const std::uint32_t n = 60;
+    DynamicCsrGraph<> graph{generateRingGraph(n), 0.0, 1};
+    std::vector<std::set<std::uint32_t>> expected(n);
+    for (std::uint32_t v = 0; v < n; ++v) {
+        expected[v] = neighborsOf(graph, v);
+    }
+
+    std::mt19937 random_gen{5};
+    std::uniform_int_distribution<std::uint32_t> vertex{0, n - 1};
+    std::bernoulli_distribution insert{0.7};
+    std::uint64_t num_edges = n;
+    for (std::uint32_t step = 0; step < 20000; ++step) {
+        std::uint32_t u = vertex(random_gen), v = vertex(random_gen);
+        if (insert(random_gen)) {
+            bool is_new = u != v && expected[u].insert(v).second;
+            if (is_new) {
+                expected[v].insert(u);
+            }
+            ASSERT_EQ(graph.insert_edge(u, v), is_new);
+            num_edges += is_new;
+        } else {
+            bool existed = expected[u].erase(v) == 1;
+            expected[v].erase(u);
+            ASSERT_EQ(graph.remove_edge(u, v), existed);
+            num_edges -= existed;
+        }
+        // Everything is checked regularly, and while the graph is still sparse enough to move lists
+        if (step % 97 == 0 || step < 500) {
+            for (std::uint32_t w = 0; w < n; ++w) {
+                ASSERT_EQ(neighborsOf(graph, w), expected[w]) << "step " << step << ", vertex " << w;
+                ASSERT_EQ(graph.degree(w), expected[w].size());
+            }
+        }
+    }
+    ASSERT_EQ(graph.num_edges(), num_edges);
+}
+
+TEST(DynamicGraphTest, ReadsTopologyChangesInTimeOrder) {
+    const std::string path = ::testing::TempDir() + "dynamic_graph_test_changes.txt";
+    std::ofstream{path} << "# time kind u v\n5 + 0 2\n\n1 - 0 1  # comment\n5 - 1 2\n";
+    auto changes = readTopologyChanges(path);
+    std::ofstream{path} << "1 * 0 1\n";
+    ASSERT_THROW(readTopologyChanges(path), std::runtime_error);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(changes.size(), 3);
+    ASSERT_EQ(changes[0]._time, 1);
+    ASSERT_FALSE(changes[0]._insert);
+    ASSERT_EQ(changes[1]._v, 2);
+    ASSERT_TRUE(changes[1]._insert);
+    ASSERT_EQ(changes[2]._u, 1);
+}
+
+// Coroutine nodes keep their neighbor range across suspensions, which the insertions move and the deletions shrink
+TEST(DynamicGraphTest, CoroutineNodesFollowTopologyChanges) {
+    std::default_random_engine random_gen{11};
+    const std::uint32_t n = 100;
+    std::vector<TopologyChange<std::uint32_t>> changes;
+    std::uniform_int_distribution<std::uint32_t> vertex{0, n - 1};
+    for (std::uint32_t time = 1; time < 40; ++time) {
+        for (std::uint32_t i = 0; i < 10; ++i) {
+            changes.push_back({time, vertex(random_gen), vertex(random_gen), i % 4 != 0});
+        }
+    }
+
+    for (bool coroutine : {false, true}) {
+        auto run = [&](auto graph) {
+            DynamicCsrGraph<typename decltype(graph)::vertex_bundled> dynamic_graph{graph, 0.0, 1};
+            AsyncSimulation<SyncDelay, SilentLogging, decltype(dynamic_graph)> simulation{dynamic_graph, SyncDelay{}, 3};
+            simulation.schedule_topology_changes(changes);
+            ASSERT_EQ(simulation.run(), n - 1);
+        };
+        Graph graph = generateRingGraph(n, 0.5, random_gen);
+        if (coroutine) {
+            run(makeCoroutineGraph(graph));
+        } else {
+            run(graph);
+        }
+    }
+}
+
+// Node 3 loses both ring edges and gets a new one at the same time, and runs its logic in between without neighbors
+TEST(DynamicGraphTest, NodesSurviveLosingEveryNeighbor) {
+    const std::uint32_t n = 6;
+    std::vector<TopologyChange<std::uint32_t>> changes{{3, 3, 4, false}, {3, 3, 2, false}, {3, 3, 0, true}};
+
+    for (bool coroutine : {false, true}) {
+        auto run = [&](auto graph) {
+            DynamicCsrGraph<typename decltype(graph)::vertex_bundled> dynamic_graph{graph};
+            AsyncSimulation<SyncDelay, SilentLogging, decltype(dynamic_graph)> simulation{dynamic_graph, SyncDelay{}, 1};
+            simulation.schedule_topology_changes(changes);
+            ASSERT_EQ(simulation.run(), n - 1);
+        };
+        std::default_random_engine random_gen{1};
+        Graph graph = generateRingGraph(n, 1.0, random_gen);
+        if (coroutine) {
+            run(makeCoroutineGraph(graph));
+        } else {
+            run(graph);
+        }
+    }
+}
+
+// Node 5 is cut off from the rest of the ring, and would never hear of the completion
+TEST(DynamicGraphTest, RejectsChangesThatSplitTheGraph) {
+    std::vector<TopologyChange<std::uint32_t>> changes{{3, 4, 5, false}, {3, 5, 0, false}};
+
+    for (bool coroutine : {false, true}) {
+        auto run = [&](auto graph) {
+            DynamicCsrGraph<typename decltype(graph)::vertex_bundled> dynamic_graph{graph};
+            AsyncSimulation<SyncDelay, SilentLogging, decltype(dynamic_graph)> simulation{dynamic_graph, SyncDelay{}, 1};
+            simulation.schedule_topology_changes(changes);
+            ASSERT_THROW(simulation.run(), std::runtime_error);
+        };
+        std::default_random_engine random_gen{1};
+        Graph graph = generateRingGraph(6, 1.0, random_gen);
+        if (coroutine) {
+            run(makeCoroutineGraph(graph));
+        } else {
+            run(graph);
+        }
+    }
+}
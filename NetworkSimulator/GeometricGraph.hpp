@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Dense"
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+#include "GraphGen.hpp"
+#include "Parallel.hpp"
+#include "RandomStreams.hpp"
+
+// Points in the unit square or cube, stored one coordinate array per dimension so that
+// distance loops run over contiguous floats
+template <std::size_t Dimensions>
+struct PointSet
+{
+    std::array<std::vector<float>, Dimensions> _coordinates{};
+
+    std::size_t size() const { return _coordinates[0].size(); }
+
+    float squared_distance(std::uint32_t a, std::uint32_t b) const
+    {
+        float sum = 0.0f;
+        for (std::size_t d = 0; d < Dimensions; ++d)
+        {
+            float delta = _coordinates[d][a] - _coordinates[d][b];
+            sum += delta * delta;
+        }
+        return sum;
+    }
+
+    // Euclidean distance between points a and b, e.g. for delays that grow with distance
+    float distance(std::uint32_t a, std::uint32_t b) const { return std::sqrt(squared_distance(a, b)); }
+};
+
+// Random geometric graph and the position of each node, node v sits at point v
+template <typename NodeType, std::size_t Dimensions>
+struct GeometricGraph
+{
+    CsrGraph<NodeType> _graph;
+    PointSet<Dimensions> _points;
+};
+
+namespace detail
+{
+    // Cells per chunk of the edge search
+    constexpr std::uint64_t geometric_cells_per_chunk = 1024;
+
+    // Tests point `point` against points [begin, end) of the cell-sorted arrays and appends
+    // the pairs closer than the radius. The squared distances are computed first as Eigen array
+    // expressions over the contiguous coordinates, which use SIMD packets, then the hits are collected.
+    template <std::size_t Dimensions>
+    void appendCloserThan(const std::array<std::vector<float>, Dimensions> &sorted, const std::vector<std::uint32_t> &sorted_ids,
+                          std::uint32_t point, std::uint32_t begin, std::uint32_t end, float radius_squared,
+                          std::vector<float> &distances, std::vector<std::pair<std::uint32_t, std::uint32_t>> &edges)
+    {
+        const std::uint32_t count = end - begin;
+        distances.resize(count);
+        Eigen::Map<Eigen::ArrayXf> squared(distances.data(), count);
+        squared = (Eigen::Map<const Eigen::ArrayXf>(sorted[0].data() + begin, count) - sorted[0][point]).square();
+        for (std::size_t d = 1; d < Dimensions; ++d)
+        {
+            squared += (Eigen::Map<const Eigen::ArrayXf>(sorted[d].data() + begin, count) - sorted[d][point]).square();
+        }
+        for (std::uint32_t j = 0; j < count; ++j)
+        {
+            if (distances[j] <= radius_squared)
+            {
+                edges.emplace_back(sorted_ids[point], sorted_ids[begin + j]);
+            }
+        }
+    }
+}
+
+// Random geometric (unit disk) graph: num_nodes points uniform in the unit square (2 dimensions) or
+// cube (3 dimensions), linked when they are at most radius apart. Points are bucketed into a grid of
+// cells at least radius wide, so each point is only tested against the points of its own and adjacent
+// cells, and each pair of adjacent cells is visited once. Expected time is O(n + m) for a fixed grid.
+// Points are drawn from one random stream per chunk of nodes and the cells are searched in parallel,
+// the graph only depends on the seed.
+template <std::size_t Dimensions, typename NodeType = Node>
+GeometricGraph<NodeType, Dimensions> generateGeometricGraph(std::uint32_t num_nodes, double radius, std::uint64_t seed, std::uint32_t num_threads = 0)
+{
+    static_assert(Dimensions == 2 || Dimensions == 3, "Geometric graphs are 2 or 3 dimensional.");
+    if (!(radius > 0.0))
+    {
+        throw std::runtime_error("The connection radius must be positive.");
+    }
+
+    PointSet<Dimensions> points;
+    for (auto &coordinates : points._coordinates)
+    {
+        coordinates.resize(num_nodes);
+    }
+    const std::uint64_t num_point_chunks = (static_cast<std::uint64_t>(num_nodes) + generation_chunk_size - 1) / generation_chunk_size;
+    parallelFor(0, num_point_chunks, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t chunk = begin; chunk < end; ++chunk)
+                    {
+                        SplitMix64 random_gen{streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Points), chunk)};
+                        const std::uint32_t last = std::min<std::uint64_t>(num_nodes, (chunk + 1) * generation_chunk_size);
+                        for (std::uint32_t i = chunk * generation_chunk_size; i < last; ++i)
+                        {
+                            for (auto &coordinates : points._coordinates)
+                            {
+                                coordinates[i] = static_cast<float>(random_gen.uniform());
+                            }
+                        }
+                    } });
+
+    // Cells are at least radius wide, and there are no more cells than about twice the nodes
+    std::uint64_t cells_per_side = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(1.0 / radius));
+    const std::uint64_t max_cells_per_side = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::pow(2.0 * num_nodes, 1.0 / Dimensions)));
+    cells_per_side = std::min(cells_per_side, max_cells_per_side);
+    std::uint64_t num_cells = 1;
+    for (std::size_t d = 0; d < Dimensions; ++d)
+    {
+        num_cells *= cells_per_side;
+    }
+
+    auto cell_coordinate = [&](float x)
+    {
+        return std::min<std::uint64_t>(static_cast<std::uint64_t>(x * cells_per_side), cells_per_side - 1);
+    };
+    std::vector<std::uint32_t> cell_of(num_nodes);
+    parallelFor(0, num_nodes, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t i = begin; i < end; ++i)
+                    {
+                        std::uint64_t cell = 0;
+                        for (std::size_t d = Dimensions; d-- > 0;)
+                        {
+                            cell = cell * cells_per_side + cell_coordinate(points._coordinates[d][i]);
+                        }
+                        cell_of[i] = cell;
+                    } });
+
+    // Counting sort of the points by cell, points of a cell keep their id order
+    std::vector<std::uint32_t> cell_starts(num_cells + 1, 0);
+    for (std::uint32_t cell : cell_of)
+    {
+        ++cell_starts[cell];
+    }
+    parallelExclusiveScan(cell_starts, num_threads);
+    std::vector<std::uint32_t> sorted_ids(num_nodes);
+    {
+        std::vector<std::uint32_t> cursors(cell_starts.begin(), cell_starts.end() - 1);
+        for (std::uint32_t i = 0; i < num_nodes; ++i)
+        {
+            sorted_ids[cursors[cell_of[i]]++] = i;
+        }
+    }
+    cell_of.clear();
+    cell_of.shrink_to_fit();
+    std::array<std::vector<float>, Dimensions> sorted;
+    for (std::size_t d = 0; d < Dimensions; ++d)
+    {
+        sorted[d].resize(num_nodes);
+        for (std::uint32_t k = 0; k < num_nodes; ++k)
+        {
+            sorted[d][k] = points._coordinates[d][sorted_ids[k]];
+        }
+    }
+
+    // Cells along the first dimension are contiguous in the sorted arrays, so the three cells
+    // x - 1, x, x + 1 of a row form one span of points. Every pair of adjacent cells is visited
+    // from one side only: in the cell's own row, its later points and the next cell, plus the
+    // neighboring rows that come after it (the last nonzero component of their offset is positive).
+    std::vector<std::array<std::int64_t, Dimensions>> forward_rows;
+    {
+        std::array<std::int64_t, Dimensions> offset;
+        offset.fill(-1);
+        offset[0] = 0;
+        while (true)
+        {
+            std::int64_t last_nonzero = 0;
+            for (std::size_t d = 1; d < Dimensions; ++d)
+            {
+                last_nonzero = offset[d] != 0 ? offset[d] : last_nonzero;
+            }
+            if (last_nonzero > 0)
+            {
+                forward_rows.push_back(offset);
+            }
+            std::size_t d = 1;
+            while (d < Dimensions && offset[d] == 1)
+            {
+                offset[d++] = -1;
+            }
+            if (d == Dimensions)
+            {
+                break;
+            }
+            ++offset[d];
+        }
+    }
+
+    const float radius_squared = static_cast<float>(radius * radius);
+    const std::int64_t side = cells_per_side;
+    const std::uint64_t num_chunks = (num_cells + detail::geometric_cells_per_chunk - 1) / detail::geometric_cells_per_chunk;
+    CsrGraph<NodeType> graph = generateCsrGraphInChunks<NodeType>(num_nodes, num_chunks, num_threads, [&](std::uint64_t chunk, auto &edges)
+                                                                  {
+                                                                      std::vector<float> distances;
+                                                                      std::vector<std::pair<std::uint32_t, std::uint32_t>> spans;
+                                                                      const std::uint64_t last_cell = std::min(num_cells, (chunk + 1) * detail::geometric_cells_per_chunk);
+                                                                      for (std::uint64_t cell = chunk * detail::geometric_cells_per_chunk; cell < last_cell; ++cell)
+                                                                      {
+                                                                          std::array<std::int64_t, Dimensions> position;
+                                                                          std::uint64_t rest = cell;
+                                                                          for (std::size_t d = 0; d < Dimensions; ++d)
+                                                                          {
+                                                                              position[d] = rest % cells_per_side;
+                                                                              rest /= cells_per_side;
+                                                                          }
+                                                                          const std::int64_t first_x = std::max<std::int64_t>(position[0] - 1, 0);
+                                                                          const std::int64_t last_x = std::min<std::int64_t>(position[0] + 1, side - 1);
+
+                                                                          // Points [begin, end) of the cells x - 1 to x + 1 of each forward row
+                                                                          spans.clear();
+                                                                          for (const auto &offset : forward_rows)
+                                                                          {
+                                                                              std::int64_t row = 0;
+                                                                              bool inside = true;
+                                                                              for (std::size_t d = Dimensions; d-- > 1;)
+                                                                              {
+                                                                                  std::int64_t coordinate = position[d] + offset[d];
+                                                                                  inside = inside && coordinate >= 0 && coordinate < side;
+                                                                                  row = row * side + coordinate;
+                                                                              }
+                                                                              if (inside)
+                                                                              {
+                                                                                  spans.emplace_back(cell_starts[row * side + first_x], cell_starts[row * side + last_x + 1]);
+                                                                              }
+                                                                          }
+
+                                                                          const std::uint32_t own_row_end = cell_starts[cell - position[0] + last_x + 1];
+                                                                          for (std::uint32_t point = cell_starts[cell]; point < cell_starts[cell + 1]; ++point)
+                                                                          {
+                                                                              detail::appendCloserThan(sorted, sorted_ids, point, point + 1, own_row_end, radius_squared, distances, edges);
+                                                                              for (const auto &[begin, end] : spans)
+                                                                              {
+                                                                                  detail::appendCloserThan(sorted, sorted_ids, point, begin, end, radius_squared, distances, edges);
+                                                                              }
+                                                                          }
+                                                                      } });
+
+    return GeometricGraph<NodeType, Dimensions>{std::move(graph), std::move(points)};
+}
@@ -1,78 +1,160 @@
 #pragma once
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 #include <algorithm>
 #include <random>
 
 #include <iostream>
 #include <fstream>
+#include <string>
 
 #include "Node.hpp"
+#include "RandomStreams.hpp"
+#include "CsrBuilder.hpp"
+#include "Parallel.hpp"
+#include "UnionFind.hpp"
+#include "Connectivity.hpp"
 
-template<typename T>
-class node_pair_iterator {
-    static_assert(std::is_integral_v<T>);
-    std::pair<T, T> _pair;
-    T _mod;
-
-public:
-    node_pair_iterator(std::pair<T, T> pair, T mod) : _pair{pair}, _mod{mod} {}
-
-    bool operator==(const node_pair_iterator<T> &other) const
+// Calls body(u, v) with u < v for every edge of a G(n, p) random graph whose second node v is in
+// [first_row, last_row), ordered by v then u. Rather than flipping a coin for each pair, it draws
+// the geometric number of pairs without an edge before the next edge and jumps over them, so it
+// runs in O(rows + edges) (Batagelj and Brandes, "Efficient generation of large random networks", 2005).
+template <typename RandomEngine, typename Body>
+void forEachRandomEdgeInRows(std::uint32_t first_row, std::uint32_t last_row, double edge_probability, RandomEngine &random_gen, const Body &body)
+{
+    first_row = std::max<std::uint32_t>(first_row, 1);
+    if (!(edge_probability > 0.0))
     {
-        return _pair == other._pair && _mod == other._mod;
+        return;
     }
-
-    bool operator!=(const node_pair_iterator<T> &other) const
+    if (edge_probability >= 1.0)
     {
-        return !(*this == other);
+        for (std::uint32_t v = first_row; v < last_row; ++v)
+        {
+            for (std::uint32_t u = 0; u < v; ++u)
+            {
+                body(u, v);
+            }
+        }
+        return;
     }
 
-    node_pair_iterator& operator++() {
-        if ((_pair.second + 1) / _mod >= 1) {
-            ++_pair.first;
-            _pair.second = _pair.first + 1;
+    const double log_q = std::log1p(-edge_probability);
+    // u starts at -1 so that the first skip lands on the pair it counts
+    std::uint64_t u = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t v = first_row;
+    while (v < last_row)
+    {
+        u += 1 + geometricSkip(random_gen, log_q);
+        while (u >= v && v < last_row)
+        {
+            u -= v;
+            ++v;
         }
-        else {
-            ++_pair.second;
+        if (v < last_row)
+        {
+            body(static_cast<std::uint32_t>(u), static_cast<std::uint32_t>(v));
         }
-
-        return *this;
     }
+}
 
-    std::pair<T, T> operator*() { return _pair; }
-};
+// Every edge of a G(n, p) random graph, see forEachRandomEdgeInRows
+template <typename RandomEngine, typename Body>
+void forEachRandomEdge(std::uint32_t num_nodes, double edge_probability, RandomEngine &random_gen, const Body &body)
+{
+    forEachRandomEdgeInRows(1, num_nodes, edge_probability, random_gen, body);
+}
 
-namespace std
+// Pair (u, v) with u < v at position index in the order used by forEachRandomEdge
+inline std::pair<std::uint32_t, std::uint32_t> nodePairAt(std::uint64_t index)
 {
-template <typename T>
-struct iterator_traits<node_pair_iterator<T>> {
-    using value_type = std::pair<T, T>;
-    using reference = const value_type&;
-    using difference_type = std::ptrdiff_t;
-    using pointer = const value_type*;
-    using iterator_category = std::forward_iterator_tag;
-};
+    // Pairs with second node v start at v(v - 1) / 2, the estimate is corrected for rounding
+    std::uint64_t v = static_cast<std::uint64_t>((1.0 + std::sqrt(1.0 + 8.0 * static_cast<double>(index))) / 2.0);
+    while (v * (v - 1) / 2 > index)
+    {
+        --v;
+    }
+    while ((v + 1) * v / 2 <= index)
+    {
+        ++v;
+    }
+    return {static_cast<std::uint32_t>(index - v * (v - 1) / 2), static_cast<std::uint32_t>(v)};
 }
 
-Graph generateRandomGraph(std::uint32_t num_nodes, float initiator_probability, float edge_probability, std::default_random_engine& random_gen)
+// Calls body(u, v) with u < v for every edge of a G(n, m) random graph, which has exactly
+// num_edges edges drawn uniformly among all pairs, in the same order as forEachRandomEdge.
+// Pair indices are drawn, sorted and deduplicated until there are enough of them, which takes
+// O(m log m). Above half of the pairs, the missing edges are drawn instead.
+template <typename RandomEngine, typename Body>
+void forEachRandomEdgeExact(std::uint32_t num_nodes, std::uint64_t num_edges, RandomEngine &random_gen, const Body &body)
 {
-    // std::ofstream myfile;
-    // myfile.open("./test.edgelist");
-	// std::ofstream myfile("test.edgelist");
+    const std::uint64_t max_edges = static_cast<std::uint64_t>(num_nodes) * (num_nodes > 0 ? num_nodes - 1 : 0) / 2;
+    if (num_edges > max_edges)
+    {
+        throw std::runtime_error("More edges requested than there are node pairs.");
+    }
 
-	Graph g;
+    const bool complement = num_edges > max_edges / 2;
+    const std::uint64_t num_drawn = complement ? max_edges - num_edges : num_edges;
+
+    std::uniform_int_distribution<std::uint64_t> index_dist{0, max_edges > 0 ? max_edges - 1 : 0};
+    std::vector<std::uint64_t> drawn;
+    drawn.reserve(num_drawn);
+    while (drawn.size() < num_drawn)
+    {
+        // Collisions are rare while fewer than half of the pairs are drawn, so this converges quickly
+        std::uint64_t missing = num_drawn - drawn.size();
+        for (std::uint64_t i = 0; i < missing; ++i)
+        {
+            drawn.push_back(index_dist(random_gen));
+        }
+        std::sort(drawn.begin(), drawn.end());
+        drawn.erase(std::unique(drawn.begin(), drawn.end()), drawn.end());
+    }
 
+    if (!complement)
+    {
+        for (std::uint64_t index : drawn)
+        {
+            auto [u, v] = nodePairAt(index);
+            body(u, v);
+        }
+        return;
+    }
+
+    auto next_missing = drawn.begin();
+    std::uint64_t index = 0;
+    for (std::uint32_t v = 1; v < num_nodes; ++v)
+    {
+        for (std::uint32_t u = 0; u < v; ++u, ++index)
+        {
+            if (next_missing != drawn.end() && *next_missing == index)
+            {
+                ++next_missing;
+                continue;
+            }
+            body(u, v);
+        }
+    }
+}
+
+// Adds num_nodes nodes with _id = _x = their index, each an initiator with probability initiator_probability.
+// The initiators are printed by printInitiators once the generator has settled on a graph.
+inline void addRandomInitiatorNodes(Graph &g, std::uint32_t num_nodes, float initiator_probability, std::default_random_engine &random_gen)
+{
     bool any_initiators = false;
     std::bernoulli_distribution initiator_dist{initiator_probability};
     for (uint32_t i = 0; i < num_nodes; ++i)
     {
         auto descriptor = boost::add_vertex(Node{}, g);
         g[descriptor]._id = descriptor;
-		g[descriptor]._x = descriptor;
+        g[descriptor]._x = descriptor;
 
         if (initiator_dist(random_gen)) {
-            std::cout << "Node " << i << " is an initiator" << std::endl;
             g[descriptor]._initiator = true;
             any_initiators = true;
         }
@@ -81,35 +163,193 @@ Graph generateRandomGraph(std::uint32_t num_nodes, float initiator_probability,
     if (!any_initiators) {
         throw std::runtime_error("No initiators.");
     }
+}
 
-    const std::uint64_t max_edges = num_nodes * (num_nodes - 1) / 2;
+// Prints the initiators of the graph a generator returns, once
+inline void printInitiators(const Graph &g)
+{
+    for (std::uint32_t v = 0; v < boost::num_vertices(g); ++v)
+    {
+        if (g[v]._initiator)
+        {
+            std::cout << "Node " << v << " is an initiator" << std::endl;
+        }
+    }
+}
 
-    using NumEdgesDistribution = std::binomial_distribution<std::uint64_t>;
-    std::uint64_t num_edges = NumEdgesDistribution{max_edges, edge_probability}(random_gen);
+// What the random graph generators do when the sampled graph is not connected
+enum class ConnectivityPolicy
+{
+    // Return it as sampled
+    Unchecked,
+    // Sample again from seeds derived from the generator, up to max_connection_attempts samples
+    Retry,
+    // Keep the largest connected component, renumbered from 0
+    GiantComponent,
+    // Link every other component to a random node of the largest one, one edge per component
+    Bridge,
+};
 
-    std::cout << "Generating " << num_edges << " edges" << std::endl;
-    std::vector<std::pair<std::uint32_t, std::uint32_t>> sampled_edges;
-    std::sample(
-        node_pair_iterator<std::uint32_t>{{0, 1}, num_nodes},
-        node_pair_iterator<std::uint32_t>{{num_nodes - 1, num_nodes}, num_nodes},
-        std::back_inserter(sampled_edges),
-        num_edges,
-        random_gen
-    );
+constexpr std::uint32_t max_connection_attempts = 100;
 
-    for (const auto &pair : sampled_edges)
+inline ConnectivityPolicy parseConnectivityPolicy(const std::string &name)
+{
+    if (name == "none")
+        return ConnectivityPolicy::Unchecked;
+    if (name == "retry")
+        return ConnectivityPolicy::Retry;
+    if (name == "giant")
+        return ConnectivityPolicy::GiantComponent;
+    if (name == "bridge")
+        return ConnectivityPolicy::Bridge;
+    throw std::runtime_error("Unknown connectivity policy : " + name);
+}
+
+namespace detail
+{
+    // Calls sample(g, components, random_gen), which adds the nodes and edges of one random graph to g
+    // and unite()s the endpoints of every edge in components, then applies the policy. The components
+    // are tracked while the edges are added, so connectivity costs O(m α(n)) on top of the sampling.
+    template <typename Sample>
+    Graph sampleConnectedGraph(ConnectivityPolicy policy, std::default_random_engine &random_gen, const Sample &sample)
     {
-        // std::cout << "Adding edge: (" << pair.first << ", " << pair.second << ")" << std::endl;
-        boost::add_edge(pair.first, pair.second, g);
-		// myfile << pair.first << " " << pair.second << "\n";
-		// std::cout << "Written to myfile : " << pair.first << " " << pair.second << std::endl;
+        Graph g;
+        UnionFind components;
+        sample(g, components, random_gen);
+        if (policy == ConnectivityPolicy::Unchecked || components.num_sets() <= 1)
+        {
+            return g;
+        }
+
+        if (policy == ConnectivityPolicy::Retry)
+        {
+            // Sample i is drawn from its own seed, so it doesn't depend on how much randomness the earlier samples used
+            const std::uint64_t retry_seed = random_gen();
+            for (std::uint32_t attempt = 1; attempt < max_connection_attempts && components.num_sets() > 1; ++attempt)
+            {
+                std::cout << "The graph is not connected, sampling again" << std::endl;
+                std::default_random_engine attempt_gen{static_cast<std::default_random_engine::result_type>(streamSeed(retry_seed, attempt))};
+                g = Graph{};
+                sample(g, components, attempt_gen);
+            }
+            if (components.num_sets() > 1)
+            {
+                throw std::runtime_error("No connected graph in " + std::to_string(max_connection_attempts) + " samples.");
+            }
+            return g;
+        }
+
+        const std::uint32_t n = boost::num_vertices(g);
+        std::uint32_t giant = 0;
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            if (components.set_size(v) > components.set_size(giant))
+            {
+                giant = v;
+            }
+        }
+        giant = components.find(giant);
+
+        if (policy == ConnectivityPolicy::Bridge)
+        {
+            std::vector<std::uint32_t> giant_nodes;
+            for (std::uint32_t v = 0; v < n; ++v)
+            {
+                if (components.find(v) == giant)
+                {
+                    giant_nodes.push_back(v);
+                }
+            }
+            std::uniform_int_distribution<std::size_t> pick{0, giant_nodes.size() - 1};
+            std::uint32_t bridges = 0;
+            for (std::uint32_t v = 0; v < n; ++v)
+            {
+                // The first node seen of every other component links it to the giant one
+                if (components.find(v) != giant)
+                {
+                    std::uint32_t target = giant_nodes[pick(random_gen)];
+                    components.unite(v, target);
+                    giant = components.find(target);
+                    boost::add_edge(v, target, g);
+                    ++bridges;
+                }
+            }
+            std::cout << "Added " << bridges << " bridging edges" << std::endl;
+            return g;
+        }
+
+        // Giant component: nodes keep their order and get _id = _x = their new index
+        std::vector<std::uint32_t> new_index(n, n);
+        Graph kept;
+        bool any_initiators = false;
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            if (components.find(v) == giant)
+            {
+                new_index[v] = boost::add_vertex(g[v], kept);
+                kept[new_index[v]]._id = new_index[v];
+                kept[new_index[v]]._x = new_index[v];
+                any_initiators |= kept[new_index[v]]._initiator;
+            }
+        }
+        auto [edges_begin, edges_end] = boost::edges(g);
+        for (auto it = edges_begin; it != edges_end; ++it)
+        {
+            std::uint32_t u = boost::source(*it, g);
+            if (new_index[u] != n)
+            {
+                boost::add_edge(new_index[u], new_index[boost::target(*it, g)], kept);
+            }
+        }
+        std::cout << "Kept the giant component : " << boost::num_vertices(kept) << " of " << n << " nodes, renumbered" << std::endl;
+        if (!any_initiators)
+        {
+            throw std::runtime_error("No initiators in the giant component.");
+        }
+        return kept;
     }
-	
-	// myfile.close();
+}
+
+// G(n, p): every pair of nodes is linked with probability edge_probability. The policy decides
+// what happens when the sample is not connected, only Unchecked can return a disconnected graph.
+inline Graph generateRandomGraph(std::uint32_t num_nodes, float initiator_probability, float edge_probability, std::default_random_engine& random_gen,
+                          ConnectivityPolicy policy = ConnectivityPolicy::Unchecked)
+{
+    Graph g = detail::sampleConnectedGraph(policy, random_gen, [&](Graph &sample, UnionFind &components, std::default_random_engine &sample_gen)
+                                           {
+                                               addRandomInitiatorNodes(sample, num_nodes, initiator_probability, sample_gen);
+                                               components = UnionFind{num_nodes};
+                                               forEachRandomEdge(num_nodes, edge_probability, sample_gen, [&](std::uint32_t u, std::uint32_t v)
+                                                                 {
+                                                                     boost::add_edge(u, v, sample);
+                                                                     components.unite(u, v);
+                                                                 }); });
+
+    printInitiators(g);
+    std::cout << "Generated " << boost::num_edges(g) << " edges" << std::endl;
+    return g;
+}
+
+// G(n, m): exactly num_edges edges, chosen uniformly among all pairs of nodes
+inline Graph generateRandomGraphWithEdgeCount(std::uint32_t num_nodes, float initiator_probability, std::uint64_t num_edges, std::default_random_engine& random_gen,
+                                       ConnectivityPolicy policy = ConnectivityPolicy::Unchecked)
+{
+    Graph g = detail::sampleConnectedGraph(policy, random_gen, [&](Graph &sample, UnionFind &components, std::default_random_engine &sample_gen)
+                                           {
+                                               addRandomInitiatorNodes(sample, num_nodes, initiator_probability, sample_gen);
+                                               components = UnionFind{num_nodes};
+                                               forEachRandomEdgeExact(num_nodes, num_edges, sample_gen, [&](std::uint32_t u, std::uint32_t v)
+                                                                      {
+                                                                          boost::add_edge(u, v, sample);
+                                                                          components.unite(u, v);
+                                                                      }); });
+
+    printInitiators(g);
+    std::cout << "Generated " << boost::num_edges(g) << " edges" << std::endl;
     return g;
 }
 
-Graph generateLineGraph(std::uint32_t num_nodes)
+inline Graph generateLineGraph(std::uint32_t num_nodes)
 {
     Graph g;
     std::optional<boost::graph_traits<Graph>::vertex_descriptor> first_descriptor, last_descriptor;
@@ -133,7 +373,7 @@ Graph generateLineGraph(std::uint32_t num_nodes)
     return g;
 }
 
-Graph generateRingGraph(std::uint32_t num_nodes, float initiator_probability, std::default_random_engine& random_gen)
+inline Graph generateRingGraph(std::uint32_t num_nodes, float initiator_probability, std::default_random_engine& random_gen)
 {
     Graph g;
     std::optional<boost::graph_traits<Graph>::vertex_descriptor> first_descriptor, last_descriptor;
@@ -173,9 +413,18 @@ Graph generateRingGraph(std::uint32_t num_nodes, float initiator_probability, st
     return g;
 }
 
+// Ring without initiators, e.g. to test the graph algorithms
+inline Graph generateRingGraph(std::uint32_t num_nodes)
+{
+    Graph g = generateLineGraph(num_nodes);
+    if (num_nodes > 2)
+    {
+        boost::add_edge(0, num_nodes - 1, g);
+    }
+    return g;
+}
 
-
-Graph generateHyperCubeGraph(std::uint32_t num_nodes, float initiator_probability, std::default_random_engine& random_gen)
+inline Graph generateHyperCubeGraph(std::uint32_t num_nodes, float initiator_probability, std::default_random_engine& random_gen)
 {
 	Graph g;
 
@@ -218,7 +467,7 @@ Graph generateHyperCubeGraph(std::uint32_t num_nodes, float initiator_probabilit
 
 
 
-Graph generateConnectedRingsGraph(std::uint32_t num_nodes_a, std::uint32_t num_nodes_b)
+inline Graph generateConnectedRingsGraph(std::uint32_t num_nodes_a, std::uint32_t num_nodes_b)
 {
     Graph g;
     std::vector<boost::graph_traits<Graph>::vertex_descriptor> first_descriptors;
@@ -248,4 +497,687 @@ Graph generateConnectedRingsGraph(std::uint32_t num_nodes_a, std::uint32_t num_n
     boost::add_edge(first_descriptors[0], first_descriptors[1], g);
     
     return g;
-}
\ No newline at end of file
+}
+
+// Calls body(v, targets) for every node v >= 1 of a Barabasi-Albert preferential attachment graph, where
+// targets holds the distinct earlier nodes v links to. Each node draws edges_per_node endpoints of the
+// edges that exist before it, so a node is picked with probability proportional to its degree. Keeping
+// every endpoint in one array makes each draw O(1) and the whole graph O(m)
+// (Batagelj and Brandes, "Efficient generation of large random networks", 2005).
+// Node 1 links to node 0 and every later node links to at least one earlier node, so the graph is connected.
+template <typename RandomEngine, typename Body>
+void forEachPreferentialAttachment(std::uint32_t num_nodes, std::uint32_t edges_per_node, RandomEngine &random_gen, const Body &body)
+{
+    if (edges_per_node == 0)
+    {
+        throw std::runtime_error("Preferential attachment needs at least one edge per node.");
+    }
+
+    // Edge e = v * edges_per_node + i goes from node v to endpoints[2e + 1], endpoints[2e] = v
+    std::vector<std::uint32_t> endpoints;
+    endpoints.reserve(2 * static_cast<std::uint64_t>(num_nodes) * edges_per_node);
+    endpoints.resize(2 * static_cast<std::uint64_t>(edges_per_node));
+    std::vector<std::uint32_t> targets;
+    for (std::uint32_t v = 1; v < num_nodes; ++v)
+    {
+        // Node 0 has no edges of its own, its slots point at it so that node 1 links to it
+        std::uniform_int_distribution<std::uint64_t> endpoint_dist{0, 2 * static_cast<std::uint64_t>(v) * edges_per_node - 1};
+        targets.clear();
+        for (std::uint32_t i = 0; i < edges_per_node; ++i)
+        {
+            std::uint32_t target = endpoints[endpoint_dist(random_gen)];
+            endpoints.push_back(v);
+            endpoints.push_back(target);
+            targets.push_back(target);
+        }
+        // Several draws can pick the same node, they make a single edge
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+        body(v, targets);
+    }
+}
+
+// Scale-free graph in which each new node attaches to edges_per_node earlier nodes by preferential attachment
+inline Graph generateScaleFreeGraph(std::uint32_t num_nodes, std::uint32_t edges_per_node, float initiator_probability, std::default_random_engine& random_gen)
+{
+    Graph g;
+    addRandomInitiatorNodes(g, num_nodes, initiator_probability, random_gen);
+
+    forEachPreferentialAttachment(num_nodes, edges_per_node, random_gen, [&](std::uint32_t v, const std::vector<std::uint32_t> &targets)
+                                  {
+                                      for (std::uint32_t target : targets)
+                                      {
+                                          boost::add_edge(v, target, g);
+                                      } });
+
+    printInitiators(g);
+    std::cout << "Generated " << boost::num_edges(g) << " edges" << std::endl;
+    return g;
+}
+
+// Parallel generators
+//
+// The generators below build a CsrGraph on several threads. The work is cut into chunks that only
+// depend on the graph parameters, and every chunk draws from its own SplitMix64 stream seeded with
+// streamSeed(seed, stream id, chunk). Threads take whole chunks and CsrBuilder sorts the neighbor
+// lists, so a given seed gives the same graph for any number of threads.
+// A new generator only has to say which edges a chunk contains, see generateCsrGraphInChunks.
+
+// Vertices per chunk for generators that split the work by vertex
+constexpr std::uint32_t generation_chunk_size = 1 << 16;
+
+// Ids of the random streams drawn by the parallel generators
+enum class GenerationStream : std::uint64_t
+{
+    Initiators,
+    Edges,
+    Points,
+    Repairs,
+    Permutation,
+    Retries,
+    Bridges
+};
+
+// Builds a CsrGraph on num_nodes vertices from num_chunks chunks, chunk_edges(chunk, edges)
+// appends the edges of one chunk to edges. Chunks are processed in parallel.
+template <typename NodeType, typename ChunkEdges>
+CsrGraph<NodeType> generateCsrGraphInChunks(std::uint32_t num_nodes, std::uint64_t num_chunks, std::uint32_t num_threads, const ChunkEdges &chunk_edges, bool deduplicate = false)
+{
+    CsrBuilder<NodeType> builder{num_nodes, CsrBuildOptions{true, deduplicate, num_threads}};
+    parallelFor(0, num_chunks, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t chunk = begin; chunk < end; ++chunk)
+                    {
+                        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+                        chunk_edges(chunk, edges);
+                        builder.add_edges(std::move(edges));
+                    } });
+    return builder.build();
+}
+
+// Marks each node as an initiator with probability initiator_probability, drawing from one stream per
+// chunk of vertices so that the choice doesn't depend on num_threads
+template <typename GraphType>
+void chooseInitiators(GraphType &g, float initiator_probability, std::uint64_t seed, std::uint32_t num_threads)
+{
+    const std::uint32_t n = num_vertices(g);
+    const std::uint64_t num_chunks = (static_cast<std::uint64_t>(n) + generation_chunk_size - 1) / generation_chunk_size;
+    parallelFor(0, num_chunks, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t chunk = begin; chunk < end; ++chunk)
+                    {
+                        SplitMix64 random_gen{streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Initiators), chunk)};
+                        const std::uint32_t last = std::min<std::uint64_t>(n, (chunk + 1) * generation_chunk_size);
+                        for (std::uint32_t i = chunk * generation_chunk_size; i < last; ++i)
+                        {
+                            g[i]._initiator = random_gen.uniform() < initiator_probability;
+                        }
+                    } });
+
+    bool any_initiators = false;
+    for (std::uint32_t i = 0; i < n; ++i)
+    {
+        if (g[i]._initiator)
+        {
+            std::cout << "Node " << i << " is an initiator" << std::endl;
+            any_initiators = true;
+        }
+    }
+
+    if (!any_initiators)
+    {
+        throw std::runtime_error("No initiators.");
+    }
+}
+
+namespace detail
+{
+    // Label of the largest component, the first one on ties
+    inline std::uint32_t largestComponent(const ComponentLabels &components)
+    {
+        std::vector<std::uint32_t> sizes(components._num_components);
+        for (std::uint32_t label : components._labels)
+        {
+            ++sizes[label];
+        }
+        return std::max_element(sizes.begin(), sizes.end()) - sizes.begin();
+    }
+
+    // Subgraph induced by the largest component, vertices keep their order and get _id = _x = their new index
+    template <typename NodeType>
+    CsrGraph<NodeType> keepGiantComponent(const CsrGraph<NodeType> &g, const ComponentLabels &components)
+    {
+        const std::uint32_t n = g.num_vertices();
+        const std::uint32_t giant = largestComponent(components);
+        std::vector<std::uint32_t> new_index(n, n);
+        std::vector<NodeType> nodes;
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            if (components._labels[v] == giant)
+            {
+                new_index[v] = nodes.size();
+                nodes.push_back(g[v]);
+                nodes.back()._id = new_index[v];
+                nodes.back()._x = new_index[v];
+            }
+        }
+
+        // Renumbering keeps the order of the vertices, so the neighbor lists stay sorted
+        std::vector<std::uint64_t> offsets{0};
+        offsets.reserve(nodes.size() + 1);
+        std::vector<std::uint32_t> neighbors;
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            if (new_index[v] != n)
+            {
+                auto [adjacent_begin, adjacent_end] = g.adjacency(v);
+                for (auto it = adjacent_begin; it != adjacent_end; ++it)
+                {
+                    neighbors.push_back(new_index[*it]);
+                }
+                offsets.push_back(neighbors.size());
+            }
+        }
+        std::cout << "Kept the giant component : " << nodes.size() << " of " << n << " nodes, renumbered" << std::endl;
+        return CsrGraph<NodeType>{std::move(offsets), std::move(neighbors), std::move(nodes)};
+    }
+
+    // Links the first vertex of every other component to a random vertex of the largest one
+    template <typename NodeType>
+    CsrGraph<NodeType> bridgeComponents(const CsrGraph<NodeType> &g, const ComponentLabels &components, std::uint64_t seed, std::uint32_t num_threads)
+    {
+        const std::uint32_t n = g.num_vertices();
+        const std::uint32_t giant = largestComponent(components);
+        std::vector<std::uint32_t> giant_nodes;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+        edges.reserve(g.num_edges() + components._num_components - 1);
+        std::vector<bool> linked(components._num_components, false);
+        linked[giant] = true;
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            if (components._labels[v] == giant)
+            {
+                giant_nodes.push_back(v);
+            }
+            auto [adjacent_begin, adjacent_end] = g.adjacency(v);
+            for (auto it = adjacent_begin; it != adjacent_end; ++it)
+            {
+                if (v < *it)
+                {
+                    edges.emplace_back(v, *it);
+                }
+            }
+        }
+        SplitMix64 random_gen{seed};
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            if (!linked[components._labels[v]])
+            {
+                linked[components._labels[v]] = true;
+                edges.emplace_back(v, giant_nodes[random_gen() % giant_nodes.size()]);
+            }
+        }
+        std::cout << "Added " << components._num_components - 1 << " bridging edges" << std::endl;
+
+        CsrGraph<NodeType> bridged = buildCsrGraph<NodeType>(n, std::move(edges), CsrBuildOptions{false, false, num_threads});
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            bridged[v] = g[v];
+        }
+        return bridged;
+    }
+}
+
+// Applies the connectivity policy to the parallel generators, generate(seed) returns the CsrGraph drawn
+// from seed. Retry draws sample i from streamSeed(seed, Retries, i), so the graph still only depends on
+// the seed. The components are labeled with one breadth-first search, O(n + m) per sample.
+// Initiators should be chosen afterwards, since the giant component renumbers the vertices.
+template <typename Generate>
+auto generateConnectedCsrGraph(ConnectivityPolicy policy, std::uint64_t seed, std::uint32_t num_threads, const Generate &generate)
+{
+    auto g = generate(seed);
+    if (policy == ConnectivityPolicy::Unchecked)
+    {
+        return g;
+    }
+
+    ComponentLabels components = labelComponents(g);
+    if (policy == ConnectivityPolicy::Retry)
+    {
+        for (std::uint32_t attempt = 1; attempt < max_connection_attempts && components._num_components > 1; ++attempt)
+        {
+            std::cout << "The graph is not connected, sampling again" << std::endl;
+            g = generate(streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Retries), attempt));
+            components = labelComponents(g);
+        }
+        if (components._num_components > 1)
+        {
+            throw std::runtime_error("No connected graph in " + std::to_string(max_connection_attempts) + " samples.");
+        }
+        return g;
+    }
+
+    if (components._num_components <= 1)
+    {
+        return g;
+    }
+    if (policy == ConnectivityPolicy::Bridge)
+    {
+        return detail::bridgeComponents(g, components, streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Bridges)), num_threads);
+    }
+    return detail::keepGiantComponent(g, components);
+}
+
+// G(n, p) on num_threads threads (0 uses every core). Chunks are ranges of rows v holding about
+// the same number of pairs (u, v), enough of them to keep every core busy.
+template <typename NodeType = Node>
+CsrGraph<NodeType> generateRandomCsrGraph(std::uint32_t num_nodes, double edge_probability, std::uint64_t seed, std::uint32_t num_threads = 0)
+{
+    const std::uint64_t max_edges = static_cast<std::uint64_t>(num_nodes) * (num_nodes > 0 ? num_nodes - 1 : 0) / 2;
+    const double expected_edges = max_edges * std::clamp(edge_probability, 0.0, 1.0);
+    const std::uint64_t num_chunks = std::clamp<std::uint64_t>(
+        static_cast<std::uint64_t>(expected_edges / (1 << 20)) + num_nodes / generation_chunk_size, 1, std::max<std::uint32_t>(num_nodes, 1));
+
+    auto first_row = [&](std::uint64_t chunk)
+    {
+        if (chunk >= num_chunks)
+        {
+            return num_nodes;
+        }
+        return chunk == 0 ? 1 : nodePairAt(max_edges / num_chunks * chunk).second;
+    };
+
+    return generateCsrGraphInChunks<NodeType>(num_nodes, num_chunks, num_threads, [&](std::uint64_t chunk, auto &edges)
+                                              {
+                                                  SplitMix64 random_gen{streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Edges), chunk)};
+                                                  forEachRandomEdgeInRows(first_row(chunk), first_row(chunk + 1), edge_probability, random_gen, [&](std::uint32_t u, std::uint32_t v)
+                                                                          { edges.emplace_back(u, v); }); });
+}
+
+// G(n, m) as a CsrGraph. The edges are drawn on the calling thread, since forEachRandomEdgeExact sorts
+// every pair index anyway, and the CSR arrays are built on num_threads threads.
+template <typename NodeType = Node>
+CsrGraph<NodeType> generateRandomCsrGraphWithEdgeCount(std::uint32_t num_nodes, std::uint64_t num_edges, std::uint64_t seed, std::uint32_t num_threads = 0)
+{
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    SplitMix64 random_gen{streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Edges))};
+    forEachRandomEdgeExact(num_nodes, num_edges, random_gen, [&](std::uint32_t u, std::uint32_t v)
+                           { edges.emplace_back(u, v); });
+    return buildCsrGraph<NodeType>(num_nodes, std::move(edges), CsrBuildOptions{true, false, num_threads});
+}
+
+// Ring on num_threads threads, same edges as generateRingGraph
+template <typename NodeType = Node>
+CsrGraph<NodeType> generateRingCsrGraph(std::uint32_t num_nodes, std::uint32_t num_threads = 0)
+{
+    const std::uint64_t num_chunks = (static_cast<std::uint64_t>(num_nodes) + generation_chunk_size - 1) / generation_chunk_size;
+    // With 2 nodes both ends of the ring are the same edge
+    return generateCsrGraphInChunks<NodeType>(num_nodes, num_chunks, num_threads, [&](std::uint64_t chunk, auto &edges)
+                                              {
+                                                  const std::uint32_t last = std::min<std::uint64_t>(num_nodes, (chunk + 1) * generation_chunk_size);
+                                                  for (std::uint32_t i = chunk * generation_chunk_size; i < last; ++i)
+                                                  {
+                                                      edges.emplace_back(i, i + 1 == num_nodes ? 0 : i + 1);
+                                                  } },
+                                              true);
+}
+
+// Hypercube on num_threads threads, same edges as generateHyperCubeGraph
+template <typename NodeType = Node>
+CsrGraph<NodeType> generateHyperCubeCsrGraph(std::uint32_t num_nodes, std::uint32_t num_threads = 0)
+{
+    const std::uint64_t num_chunks = (static_cast<std::uint64_t>(num_nodes) + generation_chunk_size - 1) / generation_chunk_size;
+    return generateCsrGraphInChunks<NodeType>(num_nodes, num_chunks, num_threads, [&](std::uint64_t chunk, auto &edges)
+                                              {
+                                                  const std::uint32_t last = std::min<std::uint64_t>(num_nodes, (chunk + 1) * generation_chunk_size);
+                                                  for (std::uint32_t i = chunk * generation_chunk_size; i < last; ++i)
+                                                  {
+                                                      for (std::uint32_t bit = 1; bit != 0 && bit < num_nodes; bit <<= 1)
+                                                      {
+                                                          // Each edge is listed by its smaller end
+                                                          std::uint32_t j = i ^ bit;
+                                                          if (j > i && j < num_nodes)
+                                                          {
+                                                              edges.emplace_back(i, j);
+                                                          }
+                                                      }
+                                                  } });
+}
+
+// Scale-free graph on num_threads threads, with the same model as forEachPreferentialAttachment.
+// The endpoint array is never stored: the slot an edge copies its target from is a hash of the edge's
+// own slot, and a copied slot that holds a target is resolved the same way, back to a slot holding a
+// source, which is known from its position. Every edge is then computed on its own in expected O(1)
+// (Sanders and Schulz, "Scalable generation of scale-free graphs", 2016).
+template <typename NodeType = Node>
+CsrGraph<NodeType> generateScaleFreeCsrGraph(std::uint32_t num_nodes, std::uint32_t edges_per_node, std::uint64_t seed, std::uint32_t num_threads = 0)
+{
+    if (edges_per_node == 0)
+    {
+        throw std::runtime_error("Preferential attachment needs at least one edge per node.");
+    }
+
+    const std::uint64_t slots_per_node = 2 * static_cast<std::uint64_t>(edges_per_node);
+    const std::uint64_t num_chunks = (static_cast<std::uint64_t>(num_nodes) + generation_chunk_size - 1) / generation_chunk_size;
+    return generateCsrGraphInChunks<NodeType>(num_nodes, num_chunks, num_threads, [&](std::uint64_t chunk, auto &edges)
+                                              {
+                                                  const std::uint32_t last = std::min<std::uint64_t>(num_nodes, (chunk + 1) * generation_chunk_size);
+                                                  for (std::uint32_t v = std::max<std::uint64_t>(1, chunk * generation_chunk_size); v < last; ++v)
+                                                  {
+                                                      for (std::uint32_t i = 0; i < edges_per_node; ++i)
+                                                      {
+                                                          // Even slots hold their node, the odd slots of node 0 hold 0
+                                                          std::uint64_t slot = (static_cast<std::uint64_t>(v) * edges_per_node + i) * 2 + 1;
+                                                          while (slot % 2 == 1 && slot >= slots_per_node)
+                                                          {
+                                                              // Copies one of the slots of the nodes before the slot's node
+                                                              slot = streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Edges), slot) % (slot / slots_per_node * slots_per_node);
+                                                          }
+                                                          edges.emplace_back(v, slot / slots_per_node);
+                                                      }
+                                                  } },
+                                              true);
+}
+
+// Random permutation of [0, count) in which element i is ranked by the hash of (seed, i). Elements are
+// bucketed by the top bits of their hash and the buckets are sorted in parallel, the number of
+// buckets only depends on count so the permutation doesn't depend on num_threads.
+inline std::vector<std::uint64_t> hashedPermutation(std::uint64_t count, std::uint64_t seed, std::uint32_t num_threads)
+{
+    if (num_threads == 0)
+    {
+        num_threads = defaultThreadCount();
+    }
+    std::uint32_t bucket_bits = 0;
+    while (bucket_bits < 20 && (count >> (bucket_bits + 12)) > 0)
+    {
+        ++bucket_bits;
+    }
+    const std::uint64_t num_buckets = std::uint64_t{1} << bucket_bits;
+    auto key = [&](std::uint64_t i)
+    {
+        return streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Edges), i);
+    };
+    auto bucket_of = [&](std::uint64_t hash)
+    {
+        return bucket_bits == 0 ? 0 : hash >> (64 - bucket_bits);
+    };
+
+    // Per thread bucket counts, then each thread scatters its range at its offset within every bucket
+    std::vector<std::vector<std::uint64_t>> counts(num_threads, std::vector<std::uint64_t>(num_buckets, 0));
+    parallelFor(0, count, num_threads, [&](std::uint32_t thread, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t i = begin; i < end; ++i)
+                    {
+                        ++counts[thread][bucket_of(key(i))];
+                    } });
+    std::vector<std::uint64_t> bucket_starts(num_buckets + 1, 0);
+    std::uint64_t total = 0;
+    for (std::uint64_t bucket = 0; bucket < num_buckets; ++bucket)
+    {
+        bucket_starts[bucket] = total;
+        for (std::uint32_t thread = 0; thread < num_threads; ++thread)
+        {
+            std::uint64_t thread_count = counts[thread][bucket];
+            counts[thread][bucket] = total;
+            total += thread_count;
+        }
+    }
+    bucket_starts[num_buckets] = total;
+
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> ranked(count);
+    parallelFor(0, count, num_threads, [&](std::uint32_t thread, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t i = begin; i < end; ++i)
+                    {
+                        std::uint64_t hash = key(i);
+                        ranked[counts[thread][bucket_of(hash)]++] = {hash, i};
+                    } });
+    parallelFor(0, num_buckets, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t bucket = begin; bucket < end; ++bucket)
+                    {
+                        std::sort(ranked.begin() + bucket_starts[bucket], ranked.begin() + bucket_starts[bucket + 1]);
+                    } });
+
+    std::vector<std::uint64_t> permutation(count);
+    parallelFor(0, count, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t i = begin; i < end; ++i)
+                    {
+                        permutation[i] = ranked[i].second;
+                    } });
+    return permutation;
+}
+
+// Random degree-regular graph from the configuration model: every node gets degree stubs, the stubs
+// are shuffled with hashedPermutation on num_threads threads and paired in order. Self loops and
+// repeated edges are then repaired by edge switching: a bad edge (a, b) and a random edge (c, e)
+// become (a, c) and (b, e) when neither exists yet, which keeps every degree. With a constant degree
+// only O(1) edges need repairs in expectation, drawn from one random stream, so the graph only depends
+// on the seed. num_nodes * degree must be even and degree smaller than num_nodes.
+template <typename NodeType = Node>
+CsrGraph<NodeType> generateRegularCsrGraph(std::uint32_t num_nodes, std::uint32_t degree, std::uint64_t seed, std::uint32_t num_threads = 0)
+{
+    if (degree >= num_nodes || (static_cast<std::uint64_t>(num_nodes) * degree) % 2 != 0)
+    {
+        throw std::runtime_error("A regular graph needs a degree below the number of nodes and an even number of stubs.");
+    }
+
+    if (degree > (num_nodes - 1) / 2)
+    {
+        // Dense graphs have too few free pairs left for switching, their sparse complement is generated instead
+        CsrGraph<NodeType> complement = generateRegularCsrGraph<NodeType>(num_nodes, num_nodes - 1 - degree, seed, num_threads);
+        std::vector<std::uint64_t> offsets(static_cast<std::uint64_t>(num_nodes) + 1);
+        std::vector<std::uint32_t> neighbors(static_cast<std::uint64_t>(num_nodes) * degree);
+        std::vector<NodeType> nodes(num_nodes);
+        parallelFor(0, num_nodes, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                    {
+                        for (std::uint64_t v = begin; v < end; ++v)
+                        {
+                            offsets[v] = v * degree;
+                            auto [missing, missing_end] = complement.adjacency(v);
+                            std::uint64_t next = v * degree;
+                            for (std::uint32_t u = 0; u < num_nodes; ++u)
+                            {
+                                if (missing != missing_end && *missing == u)
+                                {
+                                    ++missing;
+                                }
+                                else if (u != v)
+                                {
+                                    neighbors[next++] = u;
+                                }
+                            }
+                            nodes[v]._id = v;
+                            nodes[v]._x = v;
+                        } });
+        offsets[num_nodes] = neighbors.size();
+        return CsrGraph<NodeType>{std::move(offsets), std::move(neighbors), std::move(nodes)};
+    }
+
+    // Stub s belongs to node s / degree and is paired with stub partner[s]
+    const std::uint64_t num_stubs = static_cast<std::uint64_t>(num_nodes) * degree;
+    std::vector<std::uint64_t> partner = hashedPermutation(num_stubs, seed, num_threads);
+    {
+        std::vector<std::uint64_t> order = std::move(partner);
+        partner.assign(num_stubs, 0);
+        parallelFor(0, num_stubs / 2, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                    {
+                        for (std::uint64_t pair = begin; pair < end; ++pair)
+                        {
+                            partner[order[2 * pair]] = order[2 * pair + 1];
+                            partner[order[2 * pair + 1]] = order[2 * pair];
+                        } });
+    }
+
+    auto node_of = [&](std::uint64_t stub)
+    {
+        return static_cast<std::uint32_t>(stub / degree);
+    };
+    auto multiplicity = [&](std::uint32_t u, std::uint32_t v)
+    {
+        std::uint32_t count = 0;
+        for (std::uint64_t stub = static_cast<std::uint64_t>(u) * degree; stub < static_cast<std::uint64_t>(u + 1) * degree; ++stub)
+        {
+            count += node_of(partner[stub]) == v;
+        }
+        return count;
+    };
+    // A stub is bad if it is a self loop, or if an earlier stub of its node leads to the same node
+    auto is_bad = [&](std::uint64_t stub)
+    {
+        const std::uint32_t u = node_of(stub);
+        const std::uint32_t v = node_of(partner[stub]);
+        if (u == v)
+        {
+            return true;
+        }
+        for (std::uint64_t other = static_cast<std::uint64_t>(u) * degree; other < stub; ++other)
+        {
+            if (node_of(partner[other]) == v)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Bad stubs are found in parallel, listed once per bad edge (by its smaller stub) and repaired in order
+    std::vector<std::vector<std::uint64_t>> bad_by_chunk((num_nodes + generation_chunk_size - 1) / generation_chunk_size);
+    parallelFor(0, bad_by_chunk.size(), num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t chunk = begin; chunk < end; ++chunk)
+                    {
+                        const std::uint64_t last = std::min<std::uint64_t>(num_nodes, (chunk + 1) * generation_chunk_size) * degree;
+                        for (std::uint64_t stub = chunk * generation_chunk_size * degree; stub < last; ++stub)
+                        {
+                            if (stub < partner[stub] && (is_bad(stub) || is_bad(partner[stub])))
+                            {
+                                bad_by_chunk[chunk].push_back(stub);
+                            }
+                        }
+                    } });
+
+    SplitMix64 random_gen{streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Repairs))};
+    const std::uint64_t max_attempts = 1000 * num_stubs;
+    std::uint64_t attempts = 0;
+    for (const auto &bad : bad_by_chunk)
+    {
+        for (std::uint64_t stub : bad)
+        {
+            // An earlier switch may already have fixed it
+            while (is_bad(stub) || is_bad(partner[stub]))
+            {
+                if (++attempts > max_attempts)
+                {
+                    throw std::runtime_error("Could not repair the regular graph, the degree is too close to the number of nodes.");
+                }
+                const std::uint64_t other = random_gen() % num_stubs;
+                const std::uint64_t stub_end = partner[stub];
+                const std::uint64_t other_end = partner[other];
+                const std::uint32_t a = node_of(stub), b = node_of(stub_end), c = node_of(other), e = node_of(other_end);
+                // (a, c) and (b, e) must be new, distinct, and not self loops
+                if (other == stub || other == stub_end || a == c || b == e || multiplicity(a, c) > 0 || multiplicity(b, e) > 0 ||
+                    (std::min(a, c) == std::min(b, e) && std::max(a, c) == std::max(b, e)))
+                {
+                    continue;
+                }
+                partner[stub] = other;
+                partner[other] = stub;
+                partner[stub_end] = other_end;
+                partner[other_end] = stub_end;
+            }
+        }
+    }
+
+    std::vector<std::uint64_t> offsets(static_cast<std::uint64_t>(num_nodes) + 1);
+    std::vector<std::uint32_t> neighbors(num_stubs);
+    std::vector<NodeType> nodes(num_nodes);
+    parallelFor(0, num_nodes, num_threads, [&](std::uint32_t, std::uint64_t begin, std::uint64_t end)
+                {
+                    for (std::uint64_t v = begin; v < end; ++v)
+                    {
+                        offsets[v] = v * degree;
+                        for (std::uint64_t stub = v * degree; stub < (v + 1) * degree; ++stub)
+                        {
+                            neighbors[stub] = node_of(partner[stub]);
+                        }
+                        std::sort(neighbors.begin() + v * degree, neighbors.begin() + (v + 1) * degree);
+                        nodes[v]._id = v;
+                        nodes[v]._x = v;
+                    } });
+    offsets[num_nodes] = num_stubs;
+    return CsrGraph<NodeType>{std::move(offsets), std::move(neighbors), std::move(nodes)};
+}
+
+// Probabilities of the four quadrants an R-MAT edge recurses into at every level: top left (a),
+// top right (b), bottom left (c) and bottom right (d = 1 - a - b - c). The defaults are Graph500's.
+struct RmatParameters
+{
+    double _a = 0.57;
+    double _b = 0.19;
+    double _c = 0.19;
+    // Relabel the vertices with a random permutation, so that the high degree vertices aren't the low ids
+    bool _permute = true;
+};
+
+// R-MAT (recursive matrix, a Kronecker graph) with 2^scale vertices and edge_factor * 2^scale generated
+// edges, built on num_threads threads. Every edge picks one quadrant of the adjacency matrix per level
+// from 32 bits of its chunk's random stream. Self loops and repeated edges are dropped by CsrBuilder,
+// so the graph has fewer edges than generated, and vertices can be isolated.
+template <typename NodeType = Node>
+CsrGraph<NodeType> generateRmatCsrGraph(std::uint32_t scale, std::uint32_t edge_factor, std::uint64_t seed, RmatParameters parameters = {}, std::uint32_t num_threads = 0)
+{
+    const double d = 1.0 - parameters._a - parameters._b - parameters._c;
+    if (scale > 31 || parameters._a < 0.0 || parameters._b < 0.0 || parameters._c < 0.0 || d < -1e-9)
+    {
+        throw std::runtime_error("R-MAT needs a scale of at most 31 and quadrant probabilities that add up to 1.");
+    }
+
+    const std::uint32_t num_nodes = std::uint32_t{1} << scale;
+    const std::uint64_t num_edges = static_cast<std::uint64_t>(edge_factor) << scale;
+    // Quadrant thresholds on a 32 bit uniform
+    const std::uint64_t below_b = static_cast<std::uint64_t>(parameters._a * 0x1.0p32);
+    const std::uint64_t below_c = static_cast<std::uint64_t>((parameters._a + parameters._b) * 0x1.0p32);
+    const std::uint64_t below_d = static_cast<std::uint64_t>((parameters._a + parameters._b + parameters._c) * 0x1.0p32);
+
+    std::vector<std::uint64_t> labels;
+    if (parameters._permute)
+    {
+        labels = hashedPermutation(num_nodes, streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Permutation)), num_threads);
+    }
+
+    constexpr std::uint64_t edges_per_chunk = 1 << 20;
+    const std::uint64_t num_chunks = (num_edges + edges_per_chunk - 1) / edges_per_chunk;
+    return generateCsrGraphInChunks<NodeType>(num_nodes, num_chunks, num_threads, [&](std::uint64_t chunk, auto &edges)
+                                              {
+                                                  SplitMix64 random_gen{streamSeed(seed, static_cast<std::uint64_t>(GenerationStream::Edges), chunk)};
+                                                  const std::uint64_t last = std::min(num_edges, (chunk + 1) * edges_per_chunk);
+                                                  edges.reserve(last - chunk * edges_per_chunk);
+                                                  for (std::uint64_t edge = chunk * edges_per_chunk; edge < last; ++edge)
+                                                  {
+                                                      std::uint32_t u = 0;
+                                                      std::uint32_t v = 0;
+                                                      std::uint64_t bits = 0;
+                                                      for (std::uint32_t level = 0; level < scale; ++level)
+                                                      {
+                                                          // One 64 bit draw covers two levels
+                                                          if (level % 2 == 0)
+                                                          {
+                                                              bits = random_gen();
+                                                          }
+                                                          const std::uint64_t uniform = bits & 0xffffffffULL;
+                                                          bits >>= 32;
+                                                          u = (u << 1) | (uniform >= below_c);
+                                                          v = (v << 1) | ((uniform >= below_b && uniform < below_c) || uniform >= below_d);
+                                                      }
+                                                      if (parameters._permute)
+                                                      {
+                                                          u = labels[u];
+                                                          v = labels[v];
+                                                      }
+                                                      edges.emplace_back(u, v);
+                                                  } },
+                                              true);
+}
@@ -0,0 +1,352 @@
+#include "GraphGen.hpp"
+#include "GeometricGraph.hpp"
+#include "BlockModel.hpp"
+#include "Connectivity.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <typename NodeType>
+std::vector<std::uint32_t> neighborsOf(const CsrGraph<NodeType> &graph, std::uint32_t v) {
+    auto [begin, end] = graph.adjacency(v);
+    return {begin, end};
+}
+
+// Sorted neighbor lists without self loops or repeats, every edge listed at both ends
+template <typename NodeType>
+void expectSimpleUndirected(const CsrGraph<NodeType> &graph) {
+    std::uint64_t endpoints = 0;
+    for (std::uint32_t v = 0; v < graph.num_vertices(); ++v) {
+        auto neighbors = neighborsOf(graph, v);
+        endpoints += neighbors.size();
+        EXPECT_TRUE(std::adjacent_find(neighbors.begin(), neighbors.end(), std::greater_equal<>{}) == neighbors.end()) << "vertex " << v;
+        for (std::uint32_t u : neighbors) {
+            EXPECT_NE(u, v);
+            auto back = neighborsOf(graph, u);
+            EXPECT_TRUE(std::binary_search(back.begin(), back.end(), v)) << u << " - " << v;
+        }
+    }
+    EXPECT_EQ(endpoints, 2 * graph.num_edges());
+}
+
+template <typename NodeType>
+void expectSameGraph(const CsrGraph<NodeType> &a, const CsrGraph<NodeType> &b) {
+    ASSERT_EQ(a.num_vertices(), b.num_vertices());
+    for (std::uint32_t v = 0; v < a.num_vertices(); ++v) {
+        ASSERT_EQ(neighborsOf(a, v), neighborsOf(b, v)) << "vertex " << v;
+    }
+}
+
+}
+
+// The cell grid finds exactly the pairs a test of every pair finds
+template <std::size_t Dimensions>
+void expectGeometricEdgesWithinRadius(std::uint32_t num_nodes, double radius) {
+    auto geometric = generateGeometricGraph<Dimensions>(num_nodes, radius, 17, 1);
+    const CsrGraph<> &graph = geometric._graph;
+    expectSimpleUndirected(graph);
+    for (std::uint32_t u = 0; u < num_nodes; ++u) {
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t v = 0; v < num_nodes; ++v) {
+            if (v != u && geometric._points.squared_distance(u, v) <= static_cast<float>(radius * radius)) {
+                expected.push_back(v);
+            }
+        }
+        ASSERT_EQ(neighborsOf(graph, u), expected) << "vertex " << u;
+    }
+    for (std::uint32_t num_threads : {2, 5}) {
+        expectSameGraph(generateGeometricGraph<Dimensions>(num_nodes, radius, 17, num_threads)._graph, graph);
+    }
+}
+
+TEST(GeometricGraphTest, LinksPointsWithinRadius2D) {
+    expectGeometricEdgesWithinRadius<2>(600, 0.07);
+    expectGeometricEdgesWithinRadius<2>(50, 0.9);
+}
+
+TEST(GeometricGraphTest, LinksPointsWithinRadius3D) {
+    expectGeometricEdgesWithinRadius<3>(600, 0.15);
+}
+
+TEST(RegularGraphTest, EveryNodeHasTheDegree) {
+    for (auto [num_nodes, degree] : {std::pair{1000u, 3u}, std::pair{101u, 4u}, std::pair{12u, 11u}, std::pair{30u, 20u}, std::pair{8u, 0u}}) {
+        CsrGraph<> graph = generateRegularCsrGraph(num_nodes, degree, 9, 1);
+        expectSimpleUndirected(graph);
+        for (std::uint32_t v = 0; v < num_nodes; ++v) {
+            ASSERT_EQ(graph.degree(v), degree) << num_nodes << " nodes, degree " << degree << ", vertex " << v;
+        }
+        expectSameGraph(generateRegularCsrGraph(num_nodes, degree, 9, 4), graph);
+    }
+}
+
+TEST(RegularGraphTest, RejectsImpossibleDegrees) {
+    ASSERT_THROW(generateRegularCsrGraph(11, 3, 1), std::runtime_error);
+    ASSERT_THROW(generateRegularCsrGraph(10, 10, 1), std::runtime_error);
+}
+
+TEST(BlockModelTest, PlantedBlocksHaveEqualSizes) {
+    BlockModel model = BlockModel::planted(10, 3, 0.5, 0.1);
+    ASSERT_EQ(model._block_sizes, (std::vector<std::uint32_t>{4, 3, 3}));
+    ASSERT_EQ(model.probability(1, 1), 0.5);
+    ASSERT_EQ(model.probability(0, 2), 0.1);
+}
+
+// p = 1 and q = 0 give one clique per block, p = 0 and q = 1 a complete multipartite graph
+TEST(BlockModelTest, ExtremeProbabilities) {
+    auto cliques = generateBlockModelCsrGraph(BlockModel::planted(10, 3, 1.0, 0.0), 5, 2);
+    expectSimpleUndirected(cliques._graph);
+    ASSERT_EQ(cliques._blocks, (std::vector<std::uint32_t>{0, 0, 0, 0, 1, 1, 1, 2, 2, 2}));
+    ASSERT_EQ(neighborsOf(cliques._graph, 5), (std::vector<std::uint32_t>{4, 6}));
+    ASSERT_EQ(cliques._graph.num_edges(), 6 + 3 + 3);
+
+    auto multipartite = generateBlockModelCsrGraph(BlockModel::planted(10, 3, 0.0, 1.0), 5, 2);
+    expectSimpleUndirected(multipartite._graph);
+    ASSERT_EQ(neighborsOf(multipartite._graph, 0), (std::vector<std::uint32_t>{4, 5, 6, 7, 8, 9}));
+    ASSERT_EQ(multipartite._graph.num_edges(), 4 * 6 + 3 * 3);
+}
+
+// Edge counts inside and between blocks are within 5 standard deviations of their expectation
+TEST(BlockModelTest, EdgeDensitiesMatchTheModel) {
+    const std::uint32_t n = 3000, k = 4;
+    const double p = 0.02, q = 0.002;
+    auto block_graph = generateBlockModelCsrGraph(BlockModel::planted(n, k, p, q), 21, 3);
+    expectSimpleUndirected(block_graph._graph);
+    std::uint64_t inside = 0, between = 0;
+    for (std::uint32_t v = 0; v < n; ++v) {
+        for (std::uint32_t u : neighborsOf(block_graph._graph, v)) {
+            (block_graph._blocks[u] == block_graph._blocks[v] ? inside : between) += u < v;
+        }
+    }
+    const double pairs_inside = k * (n / k) * (n / k - 1) / 2.0;
+    const double pairs_between = n * (n - 1) / 2.0 - pairs_inside;
+    EXPECT_NEAR(inside, p * pairs_inside, 5 * std::sqrt(p * pairs_inside));
+    EXPECT_NEAR(between, q * pairs_between, 5 * std::sqrt(q * pairs_between));
+
+    expectSameGraph(generateBlockModelCsrGraph(BlockModel::planted(n, k, p, q), 21, 1)._graph, block_graph._graph);
+}
+
+TEST(BlockModelTest, RejectsAsymmetricProbabilities) {
+    BlockModel model{{5, 5}, {0.5, 0.1, 0.2, 0.5}};
+    ASSERT_THROW(generateBlockModelCsrGraph(model, 1), std::runtime_error);
+}
+
+TEST(RmatTest, HasTheSizeAndNoRepeatedEdges) {
+    CsrGraph<> graph = generateRmatCsrGraph(10, 8, 4, {}, 2);
+    expectSimpleUndirected(graph);
+    ASSERT_EQ(graph.num_vertices(), 1024);
+    ASSERT_LE(graph.num_edges(), 8 * 1024);
+    // Repeats are dropped, but most generated edges are distinct at this size
+    ASSERT_GE(graph.num_edges(), 4 * 1024);
+    expectSameGraph(generateRmatCsrGraph(10, 8, 4, {}, 1), graph);
+    expectSameGraph(generateRmatCsrGraph(10, 8, 4, {}, 5), graph);
+}
+
+// Without the permutation, every edge of a = 1 is the self loop at 0 and every edge of b = 1 is (0, n - 1)
+TEST(RmatTest, FollowsTheQuadrantProbabilities) {
+    ASSERT_EQ(generateRmatCsrGraph(6, 4, 1, RmatParameters{1.0, 0.0, 0.0, false}).num_edges(), 0);
+    CsrGraph<> corner = generateRmatCsrGraph(6, 4, 1, RmatParameters{0.0, 1.0, 0.0, false});
+    ASSERT_EQ(corner.num_edges(), 1);
+    ASSERT_EQ(neighborsOf(corner, 0), (std::vector<std::uint32_t>{63}));
+
+    // The default skew puts the highest degree on vertex 0
+    CsrGraph<> skewed = generateRmatCsrGraph(12, 16, 2, RmatParameters{0.57, 0.19, 0.19, false});
+    for (std::uint32_t v = 1; v < skewed.num_vertices(); ++v) {
+        ASSERT_GE(skewed.degree(0), skewed.degree(v));
+    }
+}
+
+// The permutation relabels the same edges, so the degrees are the same up to order
+TEST(RmatTest, PermutationKeepsTheDegrees) {
+    auto sortedDegrees = [](const CsrGraph<> &graph) {
+        std::vector<std::uint32_t> degrees;
+        for (std::uint32_t v = 0; v < graph.num_vertices(); ++v) {
+            degrees.push_back(graph.degree(v));
+        }
+        std::sort(degrees.begin(), degrees.end());
+        return degrees;
+    };
+    CsrGraph<> permuted = generateRmatCsrGraph(11, 8, 6, RmatParameters{0.57, 0.19, 0.19, true});
+    CsrGraph<> ordered = generateRmatCsrGraph(11, 8, 6, RmatParameters{0.57, 0.19, 0.19, false});
+    ASSERT_EQ(permuted.num_edges(), ordered.num_edges());
+    ASSERT_EQ(sortedDegrees(permuted), sortedDegrees(ordered));
+    ASSERT_LT(permuted.degree(0), ordered.degree(0));
+}
+
+TEST(RmatTest, RejectsInvalidParameters) {
+    ASSERT_THROW(generateRmatCsrGraph(32, 1, 1), std::runtime_error);
+    ASSERT_THROW(generateRmatCsrGraph(4, 1, 1, RmatParameters{0.6, 0.3, 0.3}), std::runtime_error);
+    ASSERT_THROW(generateRmatCsrGraph(4, 1, 1, RmatParameters{-0.1, 0.5, 0.3}), std::runtime_error);
+}
+
+// More chunks than any of the thread counts below, with a partial last chunk, so that every thread
+// count splits the chunks differently
+constexpr std::uint32_t multi_chunk_nodes = 9 * generation_chunk_size + 1234;
+
+TEST(ParallelGeneratorTest, RandomGraphDoesNotDependOnThreads) {
+    CsrGraph<> graph = generateRandomCsrGraph(multi_chunk_nodes, 4.0 / multi_chunk_nodes, 11, 1);
+    expectSimpleUndirected(graph);
+    ASSERT_GT(graph.num_edges(), multi_chunk_nodes);
+    for (std::uint32_t num_threads : {3, 8}) {
+        expectSameGraph(generateRandomCsrGraph(multi_chunk_nodes, 4.0 / multi_chunk_nodes, 11, num_threads), graph);
+    }
+}
+
+TEST(ParallelGeneratorTest, RingDoesNotDependOnThreads) {
+    CsrGraph<> graph = generateRingCsrGraph(multi_chunk_nodes, 1);
+    ASSERT_EQ(graph.num_edges(), multi_chunk_nodes);
+    ASSERT_EQ(neighborsOf(graph, 0), (std::vector<std::uint32_t>{1, multi_chunk_nodes - 1}));
+    for (std::uint32_t num_threads : {3, 8}) {
+        expectSameGraph(generateRingCsrGraph(multi_chunk_nodes, num_threads), graph);
+    }
+}
+
+TEST(ParallelGeneratorTest, HyperCubeDoesNotDependOnThreads) {
+    CsrGraph<> graph = generateHyperCubeCsrGraph(multi_chunk_nodes, 1);
+    // Node 0 is linked to every power of two below n
+    ASSERT_EQ(graph.degree(0), std::bit_width(multi_chunk_nodes - 1));
+    for (std::uint32_t num_threads : {3, 8}) {
+        expectSameGraph(generateHyperCubeCsrGraph(multi_chunk_nodes, num_threads), graph);
+    }
+}
+
+TEST(ParallelGeneratorTest, InitiatorsDoNotDependOnThreads) {
+    auto initiators = [](std::uint32_t num_threads) {
+        CsrGraph<> graph = generateRingCsrGraph(multi_chunk_nodes, num_threads);
+        chooseInitiators(graph, 0.0001f, 5, num_threads);
+        std::vector<std::uint32_t> chosen;
+        for (std::uint32_t v = 0; v < graph.num_vertices(); ++v) {
+            if (graph[v]._initiator) {
+                chosen.push_back(v);
+            }
+        }
+        return chosen;
+    };
+    std::vector<std::uint32_t> chosen = initiators(1);
+    ASSERT_FALSE(chosen.empty());
+    // Initiators come from every chunk, not just the first one
+    ASSERT_GE(chosen.back(), 8 * generation_chunk_size);
+    ASSERT_EQ(initiators(3), chosen);
+    ASSERT_EQ(initiators(8), chosen);
+}
+
+TEST(EdgeCountGraphTest, NodePairAtFollowsTheEnumerationOrder) {
+    std::uint64_t index = 0;
+    for (std::uint32_t v = 1; v < 300; ++v) {
+        for (std::uint32_t u = 0; u < v; ++u, ++index) {
+            ASSERT_EQ(nodePairAt(index), std::make_pair(u, v)) << "index " << index;
+        }
+    }
+    // Far enough that the square root estimate has to be corrected
+    const std::uint64_t v = 3'000'000'000ULL;
+    ASSERT_EQ(nodePairAt(v * (v - 1) / 2), std::make_pair(0u, 3'000'000'000u));
+    ASSERT_EQ(nodePairAt(v * (v - 1) / 2 - 1), std::make_pair(2'999'999'998u, 2'999'999'999u));
+}
+
+// Every pair at most once with u < v, in increasing pair order, and exactly num_edges of them,
+// on both sides of half of the pairs where the missing edges are drawn instead
+TEST(EdgeCountGraphTest, DrawsExactlyTheEdgeCount) {
+    const std::uint32_t n = 60;
+    const std::uint64_t max_edges = n * (n - 1) / 2;
+    for (std::uint64_t num_edges : {std::uint64_t{0}, std::uint64_t{1}, std::uint64_t{100}, max_edges / 2, max_edges / 2 + 1, max_edges - 1, max_edges}) {
+        SplitMix64 random_gen{num_edges};
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+        forEachRandomEdgeExact(n, num_edges, random_gen, [&](std::uint32_t u, std::uint32_t v) { edges.emplace_back(u, v); });
+        ASSERT_EQ(edges.size(), num_edges);
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            ASSERT_LT(edges[i].first, edges[i].second);
+            ASSERT_LT(edges[i].second, n);
+            if (i > 0) {
+                ASSERT_LT(std::make_pair(edges[i - 1].second, edges[i - 1].first), std::make_pair(edges[i].second, edges[i].first));
+            }
+        }
+    }
+    SplitMix64 random_gen{1};
+    ASSERT_THROW(forEachRandomEdgeExact(n, max_edges + 1, random_gen, [](std::uint32_t, std::uint32_t) {}), std::runtime_error);
+}
+
+TEST(EdgeCountGraphTest, SeedGivesTheSameGraph) {
+    for (std::uint64_t num_edges : {500, 1500}) {
+        std::default_random_engine random_gen{4};
+        Graph graph = generateRandomGraphWithEdgeCount(60, 0.5f, num_edges, random_gen);
+        ASSERT_EQ(boost::num_vertices(graph), 60);
+        ASSERT_EQ(boost::num_edges(graph), num_edges);
+        std::default_random_engine same_gen{4};
+        CsrGraph<> same{generateRandomGraphWithEdgeCount(60, 0.5f, num_edges, same_gen)};
+        expectSameGraph(same, CsrGraph<>{graph});
+        for (std::uint32_t v = 0; v < 60; ++v) {
+            ASSERT_EQ(same[v]._initiator, graph[v]._initiator);
+        }
+        std::default_random_engine other_gen{5};
+        CsrGraph<> other{generateRandomGraphWithEdgeCount(60, 0.5f, num_edges, other_gen)};
+        ASSERT_NE(neighborsOf(other, 0), neighborsOf(same, 0));
+    }
+    // The CSR version draws the same pairs on any number of threads
+    CsrGraph<> graph = generateRandomCsrGraphWithEdgeCount(1000, 4000, 8, 1);
+    expectSimpleUndirected(graph);
+    ASSERT_EQ(graph.num_edges(), 4000);
+    expectSameGraph(generateRandomCsrGraphWithEdgeCount(1000, 4000, 8, 3), graph);
+}
+
+namespace {
+
+template <typename NodeType>
+std::uint32_t maxDegree(const CsrGraph<NodeType> &graph) {
+    std::uint32_t max_degree = 0;
+    for (std::uint32_t v = 0; v < graph.num_vertices(); ++v) {
+        max_degree = std::max(max_degree, graph.degree(v));
+    }
+    return max_degree;
+}
+
+}
+
+// Node 0 seeds the graph, there is no initial clique: every later node draws edges_per_node earlier
+// nodes and repeated draws make a single edge, so there are at most edges_per_node * (n - 1) edges
+TEST(ScaleFreeGraphTest, AttachesEveryNodeToDistinctEarlierNodes) {
+    const std::uint32_t n = 2000;
+    const std::uint32_t m = 3;
+    std::default_random_engine random_gen{6};
+    std::uint64_t num_edges = 0;
+    forEachPreferentialAttachment(n, m, random_gen, [&](std::uint32_t v, const std::vector<std::uint32_t> &targets) {
+        ASSERT_FALSE(targets.empty());
+        ASSERT_LE(targets.size(), std::min(v, m));
+        ASSERT_TRUE(std::adjacent_find(targets.begin(), targets.end(), std::greater_equal<>{}) == targets.end());
+        ASSERT_LT(targets.back(), v);
+        num_edges += targets.size();
+    });
+    ASSERT_LE(num_edges, m * (n - 1));
+    ASSERT_GE(num_edges, 0.95 * m * (n - 1));
+    ASSERT_THROW(forEachPreferentialAttachment(n, 0, random_gen, [](std::uint32_t, const std::vector<std::uint32_t> &) {}), std::runtime_error);
+}
+
+// Preferential attachment gives the early nodes degrees around m sqrt(n), far above the mean of 2m
+TEST(ScaleFreeGraphTest, IsConnectedWithHubs) {
+    const std::uint32_t n = 2000;
+    const std::uint32_t m = 3;
+    std::default_random_engine random_gen{6};
+    CsrGraph<> graph{generateScaleFreeGraph(n, m, 0.5f, random_gen)};
+    expectSimpleUndirected(graph);
+    ASSERT_TRUE(isConnected(graph));
+    ASSERT_LE(graph.num_edges(), m * (n - 1));
+    ASSERT_GE(graph.num_edges(), 0.95 * m * (n - 1));
+    ASSERT_GT(maxDegree(graph), 10 * 2 * m);
+
+    CsrGraph<> parallel = generateScaleFreeCsrGraph(n, m, 6, 2);
+    expectSimpleUndirected(parallel);
+    ASSERT_TRUE(isConnected(parallel));
+    ASSERT_LE(parallel.num_edges(), m * (n - 1));
+    ASSERT_GE(parallel.num_edges(), 0.95 * m * (n - 1));
+    ASSERT_GT(maxDegree(parallel), 10 * 2 * m);
+}
+
+TEST(ScaleFreeGraphTest, CsrGraphDoesNotDependOnThreads) {
+    CsrGraph<> graph = generateScaleFreeCsrGraph(multi_chunk_nodes, 2, 12, 1);
+    ASSERT_EQ(graph.num_vertices(), multi_chunk_nodes);
+    for (std::uint32_t num_threads : {3, 8}) {
+        expectSameGraph(generateScaleFreeCsrGraph(multi_chunk_nodes, 2, 12, num_threads), graph);
+    }
+}
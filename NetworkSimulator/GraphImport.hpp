@@ -0,0 +1,496 @@
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+#include "CsrBuilder.hpp"
+#include "MappedCsrGraph.hpp"
+#include "Parallel.hpp"
+
+// Readers for graphs written by other tools. The file is memory-mapped and cut into one
+// byte range per thread at line boundaries, each thread parses its range on its own.
+// Graphs are made simple on the way in (no self loops, no duplicate edges) and vertices
+// get dense indices, as the simulator expects.
+enum class GraphFileFormat
+{
+    // SNAP style: one "u v" pair per line, '#' or '%' comments, any non-negative ids
+    EdgeList,
+    // METIS: "n m [fmt [ncon]]" header, then line i lists the 1-based neighbors of vertex i
+    Metis,
+    // Matrix Market coordinate format, each entry (i, j) is an edge, values are ignored
+    MatrixMarket,
+    // Binary CSR file written by writeCsrFile
+    Csr,
+};
+
+// Binary CSR files are recognized by their magic, text formats by their extension
+// (.mtx, .graph or .metis, anything else is read as an edge list)
+inline GraphFileFormat detectGraphFileFormat(const std::string &path)
+{
+    auto has_extension = [&path](const std::string &extension)
+    {
+        return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    if (isCsrFile(path))
+        return GraphFileFormat::Csr;
+    if (has_extension(".mtx"))
+        return GraphFileFormat::MatrixMarket;
+    if (has_extension(".graph") || has_extension(".metis"))
+        return GraphFileFormat::Metis;
+    return GraphFileFormat::EdgeList;
+}
+
+namespace detail
+{
+using RawEdges = std::vector<std::pair<std::uint64_t, std::uint64_t>>;
+
+inline bool isDigit(char c)
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline void skipBlanks(const char *&p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    {
+        ++p;
+    }
+}
+
+// Parses the digits at p, 8 at a time with SWAR arithmetic while there are 8 of them.
+// Returns false if p isn't at a digit or if the number doesn't fit in 64 bits.
+inline bool parseUnsigned(const char *&p, const char *end, std::uint64_t &value)
+{
+    if (p == end || !isDigit(*p))
+    {
+        return false;
+    }
+
+    value = 0;
+    while (end - p >= 8)
+    {
+        std::uint64_t chunk;
+        std::memcpy(&chunk, p, sizeof(chunk));
+        // Every byte is in '0'...'9' iff its high nibble is 3 and adding 6 doesn't carry into it
+        if (((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL)
+        {
+            break;
+        }
+        // Combines the digits pairwise, then in fours, then the two halves
+        chunk = ((chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+        chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+        chunk = ((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+        if (value > (std::numeric_limits<std::uint64_t>::max() - chunk) / 100000000)
+        {
+            return false;
+        }
+        value = value * 100000000 + chunk;
+        p += 8;
+    }
+    while (p < end && isDigit(*p))
+    {
+        const std::uint64_t digit = *p - '0';
+        if (value > (std::numeric_limits<std::uint64_t>::max() - digit) / 10)
+        {
+            return false;
+        }
+        value = value * 10 + digit;
+        ++p;
+    }
+    return true;
+}
+
+inline const char *lineEnd(const char *p, const char *end)
+{
+    if (p >= end)
+    {
+        return end;
+    }
+    const void *newline = std::memchr(p, '\n', end - p);
+    return newline != nullptr ? static_cast<const char *>(newline) : end;
+}
+
+// Cuts [begin, end) into parts ranges that each start at the beginning of a line
+inline std::vector<const char *> lineAlignedSplits(const char *begin, const char *end, std::uint32_t parts)
+{
+    std::vector<const char *> splits(parts + 1, end);
+    splits[0] = begin;
+    for (std::uint32_t i = 1; i < parts; ++i)
+    {
+        const char *p = std::max(splits[i - 1], begin + (end - begin) * i / parts);
+        if (p > begin && p[-1] != '\n')
+        {
+            p = std::min(end, lineEnd(p, end) + 1);
+        }
+        splits[i] = p;
+    }
+    return splits;
+}
+
+// Calls parse_line(thread, line_begin, line_end) for every line, in parallel.
+// A parse_line that returns false marks the file as malformed.
+template <typename LineParser>
+void parseLines(const char *begin, const char *end, std::uint32_t num_threads, const std::string &path, const LineParser &parse_line)
+{
+    std::vector<const char *> splits = lineAlignedSplits(begin, end, num_threads);
+    std::atomic<bool> malformed = false;
+    parallelFor(0, num_threads, num_threads, [&](std::uint32_t, std::uint64_t first, std::uint64_t last)
+                {
+                    for (std::uint64_t thread = first; thread < last; ++thread)
+                    {
+                        for (const char *p = splits[thread]; p < splits[thread + 1];)
+                        {
+                            const char *line_end = lineEnd(p, splits[thread + 1]);
+                            if (!parse_line(thread, p, line_end))
+                            {
+                                malformed = true;
+                                return;
+                            }
+                            p = line_end + 1;
+                        }
+                    } });
+    if (malformed)
+    {
+        throw std::runtime_error(path + " is malformed.");
+    }
+}
+
+// Builds the graph from edges whose endpoints are already dense indices in [0, num_vertices)
+template <typename NodeType>
+CsrGraph<NodeType> buildFromRawEdges(std::uint64_t num_vertices, std::vector<RawEdges> &raw_edges, std::uint32_t num_threads, const std::string &path)
+{
+    if (num_vertices > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::runtime_error(path + " has too many vertices.");
+    }
+
+    CsrBuilder<NodeType> builder{static_cast<std::uint32_t>(num_vertices), CsrBuildOptions{true, true, num_threads}};
+    std::atomic<bool> out_of_range = false;
+    parallelFor(0, raw_edges.size(), num_threads, [&](std::uint32_t, std::uint64_t first, std::uint64_t last)
+                {
+                    for (std::uint64_t thread = first; thread < last; ++thread)
+                    {
+                        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+                        edges.reserve(raw_edges[thread].size());
+                        for (const auto &[u, v] : raw_edges[thread])
+                        {
+                            if (u >= num_vertices || v >= num_vertices)
+                            {
+                                out_of_range = true;
+                                return;
+                            }
+                            edges.emplace_back(u, v);
+                        }
+                        RawEdges{}.swap(raw_edges[thread]);
+                        builder.add_edges(std::move(edges));
+                    } });
+    if (out_of_range)
+    {
+        throw std::runtime_error(path + " has a vertex out of range.");
+    }
+    return builder.build();
+}
+
+// Replaces arbitrary ids by their rank among the ids in use, which keeps the original order.
+// Ids that fit in a small enough table are ranked with a presence table, others by sorting.
+// Returns the number of distinct ids.
+inline std::uint64_t relabelDense(std::vector<RawEdges> &raw_edges, std::uint32_t num_threads)
+{
+    std::uint64_t num_endpoints = 0;
+    std::uint64_t max_id = 0;
+    for (const auto &edges : raw_edges)
+    {
+        num_endpoints += 2 * edges.size();
+        for (const auto &[u, v] : edges)
+        {
+            max_id = std::max({max_id, u, v});
+        }
+    }
+    if (num_endpoints == 0)
+    {
+        return 0;
+    }
+
+    auto rename_all = [&](const auto &rename)
+    {
+        parallelFor(0, raw_edges.size(), num_threads, [&](std::uint32_t, std::uint64_t first, std::uint64_t last)
+                    {
+                        for (std::uint64_t thread = first; thread < last; ++thread)
+                        {
+                            for (auto &[u, v] : raw_edges[thread])
+                            {
+                                u = rename(u);
+                                v = rename(v);
+                            }
+                        } });
+    };
+
+    if (max_id < 4 * num_endpoints + 1024)
+    {
+        std::vector<std::uint64_t> ranks(max_id + 2, 0);
+        parallelFor(0, raw_edges.size(), num_threads, [&](std::uint32_t, std::uint64_t first, std::uint64_t last)
+                    {
+                        for (std::uint64_t thread = first; thread < last; ++thread)
+                        {
+                            for (const auto &[u, v] : raw_edges[thread])
+                            {
+                                std::atomic_ref{ranks[u]}.store(1, std::memory_order_relaxed);
+                                std::atomic_ref{ranks[v]}.store(1, std::memory_order_relaxed);
+                            }
+                        } });
+        parallelExclusiveScan(ranks, num_threads);
+        rename_all([&](std::uint64_t id)
+                   { return ranks[id]; });
+        return ranks.back();
+    }
+
+    std::vector<std::uint64_t> ids;
+    ids.reserve(num_endpoints);
+    for (const auto &edges : raw_edges)
+    {
+        for (const auto &[u, v] : edges)
+        {
+            ids.push_back(u);
+            ids.push_back(v);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    rename_all([&](std::uint64_t id)
+               { return std::lower_bound(ids.begin(), ids.end(), id) - ids.begin(); });
+    return ids.size();
+}
+
+inline bool isCommentOrBlank(const char *p, const char *end)
+{
+    skipBlanks(p, end);
+    return p == end || *p == '#' || *p == '%';
+}
+}
+
+// Whitespace-separated edge list, e.g. the SNAP datasets. Ids are relabeled densely in increasing order.
+template <typename NodeType = Node>
+CsrGraph<NodeType> loadEdgeList(const std::string &path, std::uint32_t num_threads = 0)
+{
+    num_threads = num_threads == 0 ? defaultThreadCount() : num_threads;
+    MappedFile file{path};
+    file.advise(MappedAccess::Sequential);
+
+    std::vector<detail::RawEdges> raw_edges(num_threads);
+    detail::parseLines(file.chars(), file.chars() + file.size(), num_threads, path, [&](std::uint32_t thread, const char *p, const char *end)
+                       {
+                           if (detail::isCommentOrBlank(p, end))
+                           {
+                               return true;
+                           }
+                           std::uint64_t u, v;
+                           detail::skipBlanks(p, end);
+                           if (!detail::parseUnsigned(p, end, u))
+                           {
+                               return false;
+                           }
+                           detail::skipBlanks(p, end);
+                           if (p < end && *p == ',')
+                           {
+                               ++p;
+                               detail::skipBlanks(p, end);
+                           }
+                           if (!detail::parseUnsigned(p, end, v))
+                           {
+                               return false;
+                           }
+                           raw_edges[thread].emplace_back(u, v);
+                           return true; });
+
+    std::uint64_t num_vertices = detail::relabelDense(raw_edges, num_threads);
+    return detail::buildFromRawEdges<NodeType>(num_vertices, raw_edges, num_threads, path);
+}
+
+// METIS graph format. Vertex sizes, vertex weights and edge weights are read past and ignored.
+template <typename NodeType = Node>
+CsrGraph<NodeType> loadMetis(const std::string &path, std::uint32_t num_threads = 0)
+{
+    num_threads = num_threads == 0 ? defaultThreadCount() : num_threads;
+    MappedFile file{path};
+    file.advise(MappedAccess::Sequential);
+    const char *p = file.chars();
+    const char *end = p + file.size();
+
+    // Header, the first line that isn't a comment
+    while (p < end && *p == '%')
+    {
+        p = std::min(end, detail::lineEnd(p, end) + 1);
+    }
+    const char *header_end = detail::lineEnd(p, end);
+    std::uint64_t header[4] = {0, 0, 0, 1};
+    std::uint32_t header_fields = 0;
+    std::string format;
+    for (detail::skipBlanks(p, header_end); p < header_end && header_fields < 4; detail::skipBlanks(p, header_end), ++header_fields)
+    {
+        const char *field = p;
+        if (!detail::parseUnsigned(p, header_end, header[header_fields]))
+        {
+            throw std::runtime_error(path + " has a malformed METIS header.");
+        }
+        if (header_fields == 2)
+        {
+            format.assign(field, p);
+        }
+    }
+    if (header_fields < 2)
+    {
+        throw std::runtime_error(path + " has a malformed METIS header.");
+    }
+    format.insert(0, 3 - std::min<std::size_t>(3, format.size()), '0');
+    const bool has_vertex_sizes = format[format.size() - 3] == '1';
+    const bool has_vertex_weights = format[format.size() - 2] == '1';
+    const bool has_edge_weights = format[format.size() - 1] == '1';
+    const std::uint64_t num_vertices = header[0];
+    const std::uint64_t vertex_values = (has_vertex_sizes ? 1 : 0) + (has_vertex_weights ? header[3] : 0);
+
+    // Vertex of the first line of each range: count the non-comment lines of every range first
+    const char *body = std::min(end, header_end + 1);
+    std::vector<const char *> splits = detail::lineAlignedSplits(body, end, num_threads);
+    std::vector<std::uint64_t> first_vertex(num_threads + 1, 0);
+    parallelFor(0, num_threads, num_threads, [&](std::uint32_t, std::uint64_t first, std::uint64_t last)
+                {
+                    for (std::uint64_t thread = first; thread < last; ++thread)
+                    {
+                        for (const char *line = splits[thread]; line < splits[thread + 1]; line = detail::lineEnd(line, splits[thread + 1]) + 1)
+                        {
+                            first_vertex[thread] += *line != '%';
+                        }
+                    } });
+    parallelExclusiveScan(first_vertex, num_threads);
+
+    std::vector<detail::RawEdges> raw_edges(num_threads);
+    std::vector<std::uint64_t> next_vertex(first_vertex.begin(), first_vertex.end() - 1);
+    detail::parseLines(body, end, num_threads, path, [&](std::uint32_t thread, const char *p, const char *line_end)
+                       {
+                           if (p < line_end && *p == '%')
+                           {
+                               return true;
+                           }
+                           const std::uint64_t v = next_vertex[thread]++;
+                           std::uint64_t value;
+                           for (std::uint64_t i = 0; i < vertex_values; ++i)
+                           {
+                               detail::skipBlanks(p, line_end);
+                               if (!detail::parseUnsigned(p, line_end, value))
+                               {
+                                   return false;
+                               }
+                           }
+                           for (detail::skipBlanks(p, line_end); p < line_end; detail::skipBlanks(p, line_end))
+                           {
+                               if (!detail::parseUnsigned(p, line_end, value) || value == 0 || v >= num_vertices)
+                               {
+                                   return false;
+                               }
+                               raw_edges[thread].emplace_back(v, value - 1);
+                               if (has_edge_weights)
+                               {
+                                   detail::skipBlanks(p, line_end);
+                                   if (!detail::parseUnsigned(p, line_end, value))
+                                   {
+                                       return false;
+                                   }
+                               }
+                           }
+                           return true; });
+
+    return detail::buildFromRawEdges<NodeType>(num_vertices, raw_edges, num_threads, path);
+}
+
+// Matrix Market "coordinate" matrices. The graph has max(rows, columns) vertices,
+// entry (i, j) is the edge between i - 1 and j - 1 whatever the symmetry or the values.
+template <typename NodeType = Node>
+CsrGraph<NodeType> loadMatrixMarket(const std::string &path, std::uint32_t num_threads = 0)
+{
+    num_threads = num_threads == 0 ? defaultThreadCount() : num_threads;
+    MappedFile file{path};
+    file.advise(MappedAccess::Sequential);
+    const char *p = file.chars();
+    const char *end = p + file.size();
+
+    const char *banner_end = detail::lineEnd(p, end);
+    std::string banner{p, banner_end};
+    std::transform(banner.begin(), banner.end(), banner.begin(), [](unsigned char c)
+                   { return std::tolower(c); });
+    if (banner.rfind("%%matrixmarket matrix coordinate", 0) != 0)
+    {
+        throw std::runtime_error(path + " is not a Matrix Market coordinate matrix.");
+    }
+
+    // Size line, the first line after the comments
+    p = banner_end;
+    while (p < end && (*p == '\n' || *p == '%'))
+    {
+        p = *p == '\n' ? p + 1 : detail::lineEnd(p, end);
+    }
+    const char *size_end = detail::lineEnd(p, end);
+    std::uint64_t rows, columns, entries;
+    detail::skipBlanks(p, size_end);
+    bool valid_size = detail::parseUnsigned(p, size_end, rows);
+    detail::skipBlanks(p, size_end);
+    valid_size = valid_size && detail::parseUnsigned(p, size_end, columns);
+    detail::skipBlanks(p, size_end);
+    valid_size = valid_size && detail::parseUnsigned(p, size_end, entries);
+    if (!valid_size)
+    {
+        throw std::runtime_error(path + " has a malformed size line.");
+    }
+
+    std::vector<detail::RawEdges> raw_edges(num_threads);
+    detail::parseLines(std::min(end, size_end + 1), end, num_threads, path, [&](std::uint32_t thread, const char *p, const char *line_end)
+                       {
+                           if (detail::isCommentOrBlank(p, line_end))
+                           {
+                               return true;
+                           }
+                           std::uint64_t i, j;
+                           detail::skipBlanks(p, line_end);
+                           if (!detail::parseUnsigned(p, line_end, i))
+                           {
+                               return false;
+                           }
+                           detail::skipBlanks(p, line_end);
+                           if (!detail::parseUnsigned(p, line_end, j) || i == 0 || j == 0)
+                           {
+                               return false;
+                           }
+                           raw_edges[thread].emplace_back(i - 1, j - 1);
+                           return true; });
+
+    return detail::buildFromRawEdges<NodeType>(std::max(rows, columns), raw_edges, num_threads, path);
+}
+
+// Reads a text graph file in the format detected from its extension.
+// Binary CSR files are mapped with MappedCsrGraph instead.
+template <typename NodeType = Node>
+CsrGraph<NodeType> loadGraphFile(const std::string &path, std::uint32_t num_threads = 0)
+{
+    switch (detectGraphFileFormat(path))
+    {
+    case GraphFileFormat::EdgeList:
+        return loadEdgeList<NodeType>(path, num_threads);
+    case GraphFileFormat::Metis:
+        return loadMetis<NodeType>(path, num_threads);
+    case GraphFileFormat::MatrixMarket:
+        return loadMatrixMarket<NodeType>(path, num_threads);
+    case GraphFileFormat::Csr:
+        break;
+    }
+    throw std::runtime_error(path + " is a binary CSR file, map it with MappedCsrGraph.");
+}
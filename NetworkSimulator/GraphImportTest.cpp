@@ -0,0 +1,94 @@
+#include "GraphImport.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::vector<std::uint32_t> neighborsOf(const CsrGraph<> &graph, std::uint32_t v) {
+    auto [begin, end] = graph.adjacency(v);
+    return {begin, end};
+}
+
+// Writes contents to a temporary file named name, removed at the end of the test
+class TemporaryFile {
+public:
+    TemporaryFile(const std::string &name, const std::string &contents) : _path{::testing::TempDir() + name} {
+        std::ofstream{_path, std::ios::binary} << contents;
+    }
+
+    ~TemporaryFile() { std::remove(_path.c_str()); }
+
+    const std::string &path() const { return _path; }
+
+private:
+    std::string _path;
+};
+
+}
+
+TEST(GraphImportTest, DetectsTheFormatFromTheExtension) {
+    ASSERT_EQ(detectGraphFileFormat("graph.mtx"), GraphFileFormat::MatrixMarket);
+    ASSERT_EQ(detectGraphFileFormat("graph.graph"), GraphFileFormat::Metis);
+    ASSERT_EQ(detectGraphFileFormat("graph.metis"), GraphFileFormat::Metis);
+    ASSERT_EQ(detectGraphFileFormat("graph.txt"), GraphFileFormat::EdgeList);
+}
+
+// Sparse ids are ranked in increasing order, comments, blank lines and commas are skipped
+TEST(GraphImportTest, LoadsEdgeLists) {
+    TemporaryFile file{"graph_import_test.txt", "# comment\n10 30\n\n30\t20\r\n% comment\n20, 10\n30 30\n10 30\n"};
+    for (std::uint32_t num_threads : {1, 3}) {
+        CsrGraph<> graph = loadGraphFile(file.path(), num_threads);
+        ASSERT_EQ(graph.num_vertices(), 3);
+        ASSERT_EQ(graph.num_edges(), 3);
+        ASSERT_EQ(neighborsOf(graph, 0), (std::vector<std::uint32_t>{1, 2}));
+        ASSERT_EQ(neighborsOf(graph, 1), (std::vector<std::uint32_t>{0, 2}));
+        ASSERT_EQ(neighborsOf(graph, 2), (std::vector<std::uint32_t>{0, 1}));
+    }
+}
+
+// Edge weights and vertex weights are read past, a vertex without neighbors has an empty line
+TEST(GraphImportTest, LoadsMetis) {
+    TemporaryFile file{"graph_import_test.graph", "% comment\n4 3 011 1\n7 2 5 3 5\n7 1 5\n7 1 5\n7\n"};
+    for (std::uint32_t num_threads : {1, 3}) {
+        CsrGraph<> graph = loadGraphFile(file.path(), num_threads);
+        ASSERT_EQ(graph.num_vertices(), 4);
+        ASSERT_EQ(graph.num_edges(), 2);
+        ASSERT_EQ(neighborsOf(graph, 0), (std::vector<std::uint32_t>{1, 2}));
+        ASSERT_EQ(neighborsOf(graph, 1), (std::vector<std::uint32_t>{0}));
+        ASSERT_EQ(neighborsOf(graph, 2), (std::vector<std::uint32_t>{0}));
+        ASSERT_TRUE(neighborsOf(graph, 3).empty());
+    }
+}
+
+TEST(GraphImportTest, LoadsMatrixMarket) {
+    TemporaryFile file{"graph_import_test.mtx", "%%MatrixMarket matrix coordinate real symmetric\n% comment\n4 4 3\n2 1 0.5\n3 2 1\n4 4 2\n"};
+    for (std::uint32_t num_threads : {1, 3}) {
+        CsrGraph<> graph = loadGraphFile(file.path(), num_threads);
+        ASSERT_EQ(graph.num_vertices(), 4);
+        ASSERT_EQ(graph.num_edges(), 2);
+        ASSERT_EQ(neighborsOf(graph, 1), (std::vector<std::uint32_t>{0, 2}));
+        ASSERT_TRUE(neighborsOf(graph, 3).empty());
+    }
+}
+
+TEST(GraphImportTest, RejectsMalformedFiles) {
+    TemporaryFile edge_list{"graph_import_test_malformed.txt", "1 2\n3 x\n"};
+    ASSERT_THROW(loadGraphFile(edge_list.path()), std::runtime_error);
+    TemporaryFile metis{"graph_import_test_malformed.graph", "2 1\n3\n1\n"};
+    ASSERT_THROW(loadGraphFile(metis.path()), std::runtime_error);
+    TemporaryFile matrix_market{"graph_import_test_malformed.mtx", "%%MatrixMarket matrix coordinate pattern general\n2 2 1\n0 1\n"};
+    ASSERT_THROW(loadGraphFile(matrix_market.path()), std::runtime_error);
+}
+
+// 2^64 - 1 is the largest id, one more must not wrap around to a small one
+TEST(GraphImportTest, RejectsIdsThatOverflow) {
+    TemporaryFile largest{"graph_import_test_largest.txt", "18446744073709551615 0\n000000000000000000000000000000001 0\n"};
+    ASSERT_EQ(loadGraphFile(largest.path()).num_edges(), 2);
+    for (std::string id : {"18446744073709551616", "18446744073709551620", "100000000000000000000"}) {
+        TemporaryFile file{"graph_import_test_overflow.txt", "0 " + id + "\n"};
+        ASSERT_THROW(loadGraphFile(file.path()), std::runtime_error) << id;
+    }
+}
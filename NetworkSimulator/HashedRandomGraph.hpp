@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <list>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+#include "ImplicitGraph.hpp"
+#include "RandomStreams.hpp"
+
+// G(n, p) graph whose edges are a pure function of (seed, n, p) and are never stored.
+//
+// The upper triangle of the adjacency matrix is cut into B x B tiles. Tile (I, J), I <= J, draws its
+// edges by geometric skipping over its cells with a SplitMix64 stream seeded from (seed, I, J),
+// so regenerating a tile costs O(1 + edges in the tile) and gives the same edges every time,
+// whichever thread asks. Each pair of vertices is covered by exactly one tile, which keeps the
+// graph undirected.
+//
+// The neighbors of a vertex in row block K come from the tiles of row K and column K,
+// so they are regenerated a whole block at a time: O(n / B + B * deg) for the B vertices of the block,
+// O(deg) per vertex when B is close to sqrt(n / deg), the default, if the whole block is read at once.
+// The most recently used blocks are kept in a small cache, so only the node states take O(n) memory.
+// A simulation reads vertices in event order, which is close to random, so the cache almost always
+// misses and adjacency(v) costs O(n / B + B * deg), about O(sqrt(n * deg)), per event. This trades
+// time for the O(m) memory of a stored graph, it is only worth it when the graph doesn't fit.
+// Every thread has its own cache, so a const graph can be read from several threads at once.
+template <typename NodeType = Node>
+class HashedRandomGraph
+{
+public:
+    using vertex_descriptor = std::uint32_t;
+    using edge_descriptor = std::pair<std::uint32_t, std::uint32_t>;
+    using adjacency_iterator = const std::uint32_t *;
+    using vertex_iterator = boost::counting_iterator<std::uint32_t>;
+    using directed_category = boost::undirected_tag;
+    using edge_parallel_category = boost::disallow_parallel_edge_tag;
+    using traversal_category = AdjacencyTraversalTag;
+    using vertices_size_type = std::uint32_t;
+    using edges_size_type = std::uint64_t;
+    using degree_size_type = std::uint32_t;
+    using vertex_bundled = NodeType;
+
+    // Adjacency of the vertices of one row block, in CSR form
+    struct DecodedBlock
+    {
+        std::uint32_t _block;
+        std::vector<std::uint32_t> _offsets;
+        std::vector<std::uint32_t> _neighbors;
+    };
+
+    // block_size = 0 picks sqrt(n / expected degree)
+    HashedRandomGraph(std::uint32_t num_vertices, double edge_probability, std::uint64_t seed, std::uint32_t block_size = 0, std::size_t cached_blocks = 4)
+        : _num_vertices{num_vertices}, _edge_probability{edge_probability}, _log_q{std::log1p(-edge_probability)},
+          _seed{seed}, _block_size{block_size}, _cached_blocks{std::max<std::size_t>(cached_blocks, 2)}, _nodes(num_vertices)
+    {
+        if (edge_probability < 0 || edge_probability > 1)
+        {
+            throw std::runtime_error("Edge probability must be in [0, 1].");
+        }
+
+        if (_block_size == 0)
+        {
+            double expected_degree = std::max(1.0, edge_probability * num_vertices);
+            _block_size = static_cast<std::uint32_t>(std::clamp(std::sqrt(num_vertices / expected_degree), 1.0, std::max(1.0, double(num_vertices))));
+        }
+        _num_blocks = num_vertices == 0 ? 0 : (num_vertices - 1) / _block_size + 1;
+
+        for (std::uint32_t v = 0; v < num_vertices; ++v)
+        {
+            _nodes[v]._id = v;
+            _nodes[v]._x = v;
+        }
+    }
+
+    std::uint32_t num_vertices() const { return _num_vertices; }
+    std::uint32_t block_size() const { return _block_size; }
+
+    // Regenerates the neighbors of every vertex in block. Doesn't touch the cache, so any number
+    // of threads can call it concurrently.
+    DecodedBlock decode_block(std::uint32_t block) const
+    {
+        const std::uint32_t first = block * _block_size;
+        const std::uint32_t rows = std::min(_block_size, _num_vertices - first);
+
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> local_edges;
+        for (std::uint32_t other = 0; other < _num_blocks; ++other)
+        {
+            if (other < block)
+            {
+                for_each_tile_edge(other, block, [&](std::uint32_t u, std::uint32_t v)
+                                   { local_edges.emplace_back(v - first, u); });
+            }
+            else
+            {
+                for_each_tile_edge(block, other, [&](std::uint32_t u, std::uint32_t v)
+                                   {
+                                       local_edges.emplace_back(u - first, v);
+                                       if (other == block)
+                                       {
+                                           local_edges.emplace_back(v - first, u);
+                                       } });
+            }
+        }
+
+        DecodedBlock decoded{block, std::vector<std::uint32_t>(rows + 1, 0), std::vector<std::uint32_t>(local_edges.size())};
+        for (const auto &[row, neighbor] : local_edges)
+        {
+            ++decoded._offsets[row + 1];
+        }
+        std::partial_sum(decoded._offsets.begin(), decoded._offsets.end(), decoded._offsets.begin());
+
+        std::vector<std::uint32_t> cursors(decoded._offsets.begin(), decoded._offsets.end() - 1);
+        for (const auto &[row, neighbor] : local_edges)
+        {
+            decoded._neighbors[cursors[row]++] = neighbor;
+        }
+
+        return decoded;
+    }
+
+    // Goes through the block cache of the calling thread, which owns the returned range: it stays valid
+    // while the same thread asks for the neighbors of vertices in at most cached_blocks - 1 other blocks,
+    // so at least until its next call.
+    std::pair<adjacency_iterator, adjacency_iterator> adjacency(std::uint32_t v) const
+    {
+        const std::uint32_t block = v / _block_size;
+        const std::uint32_t row = v % _block_size;
+
+        // Blocks are keyed by everything the edges depend on, so copies of a graph share them and a
+        // graph allocated where a destroyed one was never sees its blocks
+        auto it = std::find_if(_cache.begin(), _cache.end(), [this, block](const auto &cached)
+                               { return cached._block._block == block && cached._seed == _seed && cached._num_vertices == _num_vertices &&
+                                        cached._edge_probability == _edge_probability && cached._block_size == _block_size; });
+        if (it == _cache.end())
+        {
+            while (_cache.size() >= _cached_blocks)
+            {
+                _cache.pop_back();
+            }
+            _cache.push_front(CachedBlock{_seed, _num_vertices, _edge_probability, _block_size, decode_block(block)});
+        }
+        else if (it != _cache.begin())
+        {
+            _cache.splice(_cache.begin(), _cache, it);
+        }
+
+        const DecodedBlock &decoded = _cache.front()._block;
+        return {decoded._neighbors.data() + decoded._offsets[row], decoded._neighbors.data() + decoded._offsets[row + 1]};
+    }
+
+    NodeType &operator[](std::uint32_t v) { return _nodes[v]; }
+    const NodeType &operator[](std::uint32_t v) const { return _nodes[v]; }
+    const NodeType *node_data() const { return _nodes.data(); }
+
+private:
+    struct CachedBlock
+    {
+        std::uint64_t _seed;
+        std::uint32_t _num_vertices;
+        double _edge_probability;
+        std::uint32_t _block_size;
+        DecodedBlock _block;
+    };
+
+    template <typename Callback>
+    void for_each_tile_edge(std::uint32_t row_block, std::uint32_t column_block, const Callback &callback) const
+    {
+        if (_edge_probability <= 0)
+        {
+            return;
+        }
+
+        const std::uint32_t first_row = row_block * _block_size;
+        const std::uint32_t first_column = column_block * _block_size;
+        const std::uint64_t rows = std::min(_block_size, _num_vertices - first_row);
+        const std::uint64_t columns = std::min(_block_size, _num_vertices - first_column);
+        const std::uint64_t cells = rows * columns;
+
+        // Diagonal tiles draw every cell too and keep the upper triangle,
+        // which keeps the cell <-> pair mapping trivial
+        SplitMix64 random_gen{streamSeed(_seed, row_block, column_block)};
+        for (std::uint64_t cell = geometricSkip(random_gen, _log_q); cell < cells; cell += 1 + geometricSkip(random_gen, _log_q))
+        {
+            std::uint32_t row = cell / columns;
+            std::uint32_t column = cell % columns;
+            if (row_block == column_block && row >= column)
+            {
+                continue;
+            }
+            callback(first_row + row, first_column + column);
+        }
+    }
+
+    std::uint32_t _num_vertices;
+    double _edge_probability;
+    double _log_q;
+    std::uint64_t _seed;
+    std::uint32_t _block_size;
+    std::uint32_t _num_blocks;
+    std::size_t _cached_blocks;
+    std::vector<NodeType> _nodes;
+
+    static inline thread_local std::list<CachedBlock> _cache{};
+};
+
+template <typename NodeType>
+std::pair<boost::counting_iterator<std::uint32_t>, boost::counting_iterator<std::uint32_t>> vertices(const HashedRandomGraph<NodeType> &g)
+{
+    return {0, g.num_vertices()};
+}
+
+template <typename NodeType>
+std::uint32_t num_vertices(const HashedRandomGraph<NodeType> &g)
+{
+    return g.num_vertices();
+}
+
+template <typename NodeType>
+std::pair<const std::uint32_t *, const std::uint32_t *> adjacent_vertices(std::uint32_t v, const HashedRandomGraph<NodeType> &g)
+{
+    return g.adjacency(v);
+}
+
+template <typename NodeType, typename Member, typename T>
+NodeMemberMap<NodeType, T> get(T Member::*member, const HashedRandomGraph<NodeType> &g)
+{
+    return {g.node_data(), member};
+}
+
+// Prefetching would mean decoding the block ahead of time, which is the expensive part
+template <typename NodeType>
+void prefetchAdjacency(std::uint32_t, const HashedRandomGraph<NodeType> &)
+{
+}
+
+inline HashedRandomGraph<> generateHashedRandomGraph(std::uint32_t num_nodes, float initiator_probability, float edge_probability, std::default_random_engine &random_gen)
+{
+    HashedRandomGraph<> g{num_nodes, edge_probability, random_gen()};
+    chooseInitiators(g, initiator_probability, random_gen);
+    return g;
+}
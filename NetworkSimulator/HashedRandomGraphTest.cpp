@@ -0,0 +1,87 @@
+#include "HashedRandomGraph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Sorted copy of every neighbor list, taken right away since the cache owns the ranges
+template <typename NodeType>
+std::vector<std::vector<std::uint32_t>> adjacencyLists(const HashedRandomGraph<NodeType> &graph) {
+    std::vector<std::vector<std::uint32_t>> lists(graph.num_vertices());
+    for (std::uint32_t v = 0; v < graph.num_vertices(); ++v) {
+        auto [begin, end] = graph.adjacency(v);
+        lists[v].assign(begin, end);
+        std::sort(lists[v].begin(), lists[v].end());
+    }
+    return lists;
+}
+
+}
+
+TEST(HashedRandomGraphTest, IsSimpleAndUndirected) {
+    // The last block is partial, and the small block size gives many off-diagonal tiles
+    HashedRandomGraph<> graph{500, 0.05, 3, 7};
+    auto lists = adjacencyLists(graph);
+    for (std::uint32_t v = 0; v < 500; ++v) {
+        ASSERT_TRUE(std::adjacent_find(lists[v].begin(), lists[v].end()) == lists[v].end()) << "vertex " << v;
+        for (std::uint32_t u : lists[v]) {
+            ASSERT_NE(u, v);
+            ASSERT_TRUE(std::binary_search(lists[u].begin(), lists[u].end(), v)) << u << " - " << v;
+        }
+    }
+}
+
+// Any instance and any thread regenerates the same edges, in any order of access
+TEST(HashedRandomGraphTest, EdgesOnlyDependOnTheParameters) {
+    HashedRandomGraph<> graph{800, 0.02, 9};
+    auto lists = adjacencyLists(graph);
+
+    HashedRandomGraph<> other{800, 0.02, 9};
+    for (std::uint32_t v = 800; v-- > 0;) {
+        auto [begin, end] = other.adjacency(v);
+        std::vector<std::uint32_t> neighbors(begin, end);
+        std::sort(neighbors.begin(), neighbors.end());
+        ASSERT_EQ(neighbors, lists[v]) << "vertex " << v;
+    }
+
+    std::vector<std::vector<std::vector<std::uint32_t>>> thread_lists(4);
+    {
+        std::vector<std::jthread> threads;
+        for (std::uint32_t thread = 0; thread < 4; ++thread) {
+            threads.emplace_back([&, thread] { thread_lists[thread] = adjacencyLists(graph); });
+        }
+    }
+    for (const auto &from_thread : thread_lists) {
+        ASSERT_EQ(from_thread, lists);
+    }
+    ASSERT_NE(adjacencyLists(HashedRandomGraph<>{800, 0.02, 10}), lists);
+}
+
+// The number of edges is binomial with p * n(n - 1) / 2 expected edges
+TEST(HashedRandomGraphTest, EdgeCountMatchesTheProbability) {
+    const std::uint32_t n = 3000;
+    const double p = 0.004;
+    for (std::uint64_t seed : {1, 2, 3}) {
+        HashedRandomGraph<> graph{n, p, seed};
+        std::uint64_t endpoints = 0;
+        for (std::uint32_t v = 0; v < n; ++v) {
+            auto [begin, end] = graph.adjacency(v);
+            endpoints += end - begin;
+        }
+        const double expected = p * n * (n - 1) / 2;
+        const double deviation = std::sqrt(expected * (1 - p));
+        ASSERT_NEAR(endpoints / 2.0, expected, 5 * deviation) << "seed " << seed;
+    }
+    HashedRandomGraph<> empty{100, 0.0, 1};
+    HashedRandomGraph<> complete{100, 1.0, 1};
+    for (std::uint32_t v = 0; v < 100; ++v) {
+        auto [begin, end] = empty.adjacency(v);
+        ASSERT_EQ(end - begin, 0);
+        auto [complete_begin, complete_end] = complete.adjacency(v);
+        ASSERT_EQ(complete_end - complete_begin, 99);
+    }
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+
+// Topologies whose neighbors are pure arithmetic on the vertex index.
+// Each vertex has max_degree() neighbor slots, neighbor(v, slot) returns the vertex in that slot
+// or no_neighbor if the slot is empty (e.g. the ends of a line).
+constexpr std::uint32_t no_neighbor = std::numeric_limits<std::uint32_t>::max();
+
+// Cycle 0 - 1 - ... - (n - 1) - 0
+struct RingTopology
+{
+    std::uint32_t _num_vertices;
+
+    std::uint32_t num_vertices() const { return _num_vertices; }
+    std::uint32_t max_degree() const { return 2; }
+
+    std::uint32_t neighbor(std::uint32_t v, std::uint32_t slot) const
+    {
+        if (_num_vertices <= 2)
+        {
+            // Too short to close the ring without a parallel edge
+            return slot == 0 ? (v > 0 ? v - 1 : no_neighbor) : (v + 1 < _num_vertices ? v + 1 : no_neighbor);
+        }
+        return slot == 0 ? (v == 0 ? _num_vertices - 1 : v - 1) : (v + 1 == _num_vertices ? 0 : v + 1);
+    }
+};
+
+// Path 0 - 1 - ... - (n - 1)
+struct LineTopology
+{
+    std::uint32_t _num_vertices;
+
+    std::uint32_t num_vertices() const { return _num_vertices; }
+    std::uint32_t max_degree() const { return 2; }
+
+    std::uint32_t neighbor(std::uint32_t v, std::uint32_t slot) const
+    {
+        return slot == 0 ? (v > 0 ? v - 1 : no_neighbor) : (v + 1 < _num_vertices ? v + 1 : no_neighbor);
+    }
+};
+
+// v and v XOR (1 << k) are neighbors, same as generateHyperCubeGraph:
+// when n isn't a power of two, neighbors past n are left out
+struct HyperCubeTopology
+{
+    std::uint32_t _num_vertices;
+    std::uint32_t _dimension;
+
+    explicit HyperCubeTopology(std::uint32_t num_vertices) : _num_vertices{num_vertices}, _dimension{0}
+    {
+        while (_dimension < 32 && (std::uint64_t{1} << _dimension) < num_vertices)
+        {
+            ++_dimension;
+        }
+    }
+
+    std::uint32_t num_vertices() const { return _num_vertices; }
+    std::uint32_t max_degree() const { return _dimension; }
+
+    std::uint32_t neighbor(std::uint32_t v, std::uint32_t slot) const
+    {
+        std::uint32_t other = v ^ (std::uint32_t{1} << slot);
+        return other < _num_vertices ? other : no_neighbor;
+    }
+};
+
+// k-ary d-dimensional torus (wrap_around) or mesh, n = k^d.
+// Vertex v has coordinates (v / k^i) % k, slots 2i and 2i + 1 are the -1 and +1 neighbors in dimension i.
+struct TorusTopology
+{
+    std::uint32_t _arity;
+    std::uint32_t _dimensions;
+    bool _wrap_around;
+    std::uint32_t _num_vertices;
+    std::vector<std::uint32_t> _strides;
+
+    TorusTopology(std::uint32_t arity, std::uint32_t dimensions, bool wrap_around)
+        : _arity{arity}, _dimensions{dimensions}, _wrap_around{wrap_around}, _num_vertices{1}
+    {
+        for (std::uint32_t i = 0; i < dimensions; ++i)
+        {
+            _strides.push_back(_num_vertices);
+            if (static_cast<std::uint64_t>(_num_vertices) * arity > std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::runtime_error("Torus has too many vertices.");
+            }
+            _num_vertices *= arity;
+        }
+    }
+
+    std::uint32_t num_vertices() const { return _num_vertices; }
+    std::uint32_t max_degree() const { return 2 * _dimensions; }
+
+    std::uint32_t neighbor(std::uint32_t v, std::uint32_t slot) const
+    {
+        std::uint32_t stride = _strides[slot / 2];
+        std::uint32_t coordinate = (v / stride) % _arity;
+
+        if (slot % 2 == 0)
+        {
+            if (coordinate > 0)
+            {
+                return v - stride;
+            }
+            // With k <= 2 the wrap-around neighbor is already the +1 neighbor
+            return _wrap_around && _arity > 2 ? v + (_arity - 1) * stride : no_neighbor;
+        }
+
+        if (coordinate + 1 < _arity)
+        {
+            return v + stride;
+        }
+        return _wrap_around && _arity > 2 ? v - (_arity - 1) * stride : no_neighbor;
+    }
+};
+
+// Every pair of vertices is connected
+struct CompleteTopology
+{
+    std::uint32_t _num_vertices;
+
+    std::uint32_t num_vertices() const { return _num_vertices; }
+    std::uint32_t max_degree() const { return _num_vertices > 0 ? _num_vertices - 1 : 0; }
+
+    std::uint32_t neighbor(std::uint32_t v, std::uint32_t slot) const
+    {
+        return slot < v ? slot : slot + 1;
+    }
+};
+
+// Walks the neighbor slots of a vertex, skipping the empty ones
+template <typename Topology>
+class ImplicitAdjacencyIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::uint32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::uint32_t *;
+    using reference = std::uint32_t;
+
+    ImplicitAdjacencyIterator() = default;
+
+    ImplicitAdjacencyIterator(const Topology *topology, std::uint32_t v, std::uint32_t slot)
+        : _topology{topology}, _v{v}, _slot{slot}
+    {
+        skip_empty_slots();
+    }
+
+    std::uint32_t operator*() const { return _topology->neighbor(_v, _slot); }
+
+    ImplicitAdjacencyIterator &operator++()
+    {
+        ++_slot;
+        skip_empty_slots();
+        return *this;
+    }
+
+    ImplicitAdjacencyIterator operator++(int)
+    {
+        ImplicitAdjacencyIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    bool operator==(const ImplicitAdjacencyIterator &other) const { return _slot == other._slot; }
+    bool operator!=(const ImplicitAdjacencyIterator &other) const { return _slot != other._slot; }
+
+private:
+    void skip_empty_slots()
+    {
+        const std::uint32_t max_degree = _topology->max_degree();
+        while (_slot < max_degree && _topology->neighbor(_v, _slot) == no_neighbor)
+        {
+            ++_slot;
+        }
+    }
+
+    const Topology *_topology = nullptr;
+    std::uint32_t _v = 0;
+    std::uint32_t _slot = 0;
+};
+
+// Node states over an implicit topology, the topology itself takes O(1) memory
+template <typename Topology, typename NodeType = Node>
+class ImplicitGraph
+{
+public:
+    using vertex_descriptor = std::uint32_t;
+    using edge_descriptor = std::pair<std::uint32_t, std::uint32_t>;
+    using adjacency_iterator = ImplicitAdjacencyIterator<Topology>;
+    using vertex_iterator = boost::counting_iterator<std::uint32_t>;
+    using directed_category = boost::undirected_tag;
+    using edge_parallel_category = boost::disallow_parallel_edge_tag;
+    using traversal_category = AdjacencyTraversalTag;
+    using vertices_size_type = std::uint32_t;
+    using edges_size_type = std::uint64_t;
+    using degree_size_type = std::uint32_t;
+    using vertex_bundled = NodeType;
+
+    // Nodes get _id = _x = their index
+    explicit ImplicitGraph(Topology topology) : _topology{std::move(topology)}, _nodes(_topology.num_vertices())
+    {
+        for (std::uint32_t v = 0; v < _nodes.size(); ++v)
+        {
+            _nodes[v]._id = v;
+            _nodes[v]._x = v;
+        }
+    }
+
+    const Topology &topology() const { return _topology; }
+
+    std::uint32_t num_vertices() const { return _topology.num_vertices(); }
+
+    std::pair<adjacency_iterator, adjacency_iterator> adjacency(std::uint32_t v) const
+    {
+        return {adjacency_iterator{&_topology, v, 0}, adjacency_iterator{&_topology, v, _topology.max_degree()}};
+    }
+
+    NodeType &operator[](std::uint32_t v) { return _nodes[v]; }
+    const NodeType &operator[](std::uint32_t v) const { return _nodes[v]; }
+    const NodeType *node_data() const { return _nodes.data(); }
+
+private:
+    Topology _topology;
+    std::vector<NodeType> _nodes;
+};
+
+template <typename Topology, typename NodeType>
+std::pair<boost::counting_iterator<std::uint32_t>, boost::counting_iterator<std::uint32_t>> vertices(const ImplicitGraph<Topology, NodeType> &g)
+{
+    return {0, g.num_vertices()};
+}
+
+template <typename Topology, typename NodeType>
+std::uint32_t num_vertices(const ImplicitGraph<Topology, NodeType> &g)
+{
+    return g.num_vertices();
+}
+
+template <typename Topology, typename NodeType>
+auto adjacent_vertices(std::uint32_t v, const ImplicitGraph<Topology, NodeType> &g)
+{
+    return g.adjacency(v);
+}
+
+template <typename Topology, typename NodeType, typename Member, typename T>
+NodeMemberMap<NodeType, T> get(T Member::*member, const ImplicitGraph<Topology, NodeType> &g)
+{
+    return {g.node_data(), member};
+}
+
+// There is no adjacency storage to prefetch
+template <typename Topology, typename NodeType>
+void prefetchAdjacency(std::uint32_t, const ImplicitGraph<Topology, NodeType> &)
+{
+}
+
+// Same initiator selection as GraphGen.hpp
+template <typename GraphType>
+void chooseInitiators(GraphType &g, float initiator_probability, std::default_random_engine &random_gen)
+{
+    bool any_initiators = false;
+    std::bernoulli_distribution initiator_dist{initiator_probability};
+    for (std::uint32_t i = 0; i < num_vertices(g); ++i)
+    {
+        if (initiator_dist(random_gen))
+        {
+            std::cout << "Node " << i << " is an initiator" << std::endl;
+            g[i]._initiator = true;
+            any_initiators = true;
+        }
+    }
+
+    if (!any_initiators)
+    {
+        throw std::runtime_error("No initiators.");
+    }
+}
+
+template <typename Topology>
+ImplicitGraph<Topology> generateImplicitGraph(Topology topology, float initiator_probability, std::default_random_engine &random_gen)
+{
+    ImplicitGraph<Topology> g{std::move(topology)};
+    chooseInitiators(g, initiator_probability, random_gen);
+    return g;
+}
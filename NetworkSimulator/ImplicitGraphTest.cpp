@@ -0,0 +1,109 @@
+#include "ImplicitGraph.hpp"
+
+#include "GraphGen.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <typename GraphType>
+std::vector<std::uint32_t> sortedNeighbors(const GraphType &graph, std::uint32_t v) {
+    auto [begin, end] = graph.adjacency(v);
+    std::vector<std::uint32_t> neighbors(begin, end);
+    std::sort(neighbors.begin(), neighbors.end());
+    return neighbors;
+}
+
+template <typename Topology>
+void expectSameAsGenerated(const Topology &topology, const Graph &generated) {
+    ImplicitGraph<Topology> graph{topology};
+    CsrGraph<> expected{generated};
+    ASSERT_EQ(graph.num_vertices(), expected.num_vertices());
+    for (std::uint32_t v = 0; v < graph.num_vertices(); ++v) {
+        ASSERT_EQ(sortedNeighbors(graph, v), sortedNeighbors(expected, v)) << "vertex " << v << " of " << graph.num_vertices();
+        ASSERT_EQ(graph[v]._id, v);
+        ASSERT_EQ(graph[v]._x, v);
+    }
+}
+
+// Vertices 0 and 2 are linked through slot 1, with empty slots before and after it, vertex 1 has only empty slots
+struct GappedTopology {
+    std::uint32_t num_vertices() const { return 3; }
+    std::uint32_t max_degree() const { return 4; }
+
+    std::uint32_t neighbor(std::uint32_t v, std::uint32_t slot) const {
+        return v != 1 && slot == 1 ? 2 - v : no_neighbor;
+    }
+};
+
+}
+
+TEST(ImplicitGraphTest, RingAndLineMatchTheGenerators) {
+    for (std::uint32_t n : {1, 2, 3, 4, 7, 64}) {
+        expectSameAsGenerated(RingTopology{n}, generateRingGraph(n));
+        expectSameAsGenerated(LineTopology{n}, generateLineGraph(n));
+    }
+}
+
+// When n isn't a power of two, the neighbors past n are left out
+TEST(ImplicitGraphTest, HyperCubeMatchesTheGenerator) {
+    for (std::uint32_t n : {1, 2, 3, 5, 8, 12, 33, 64}) {
+        std::default_random_engine random_gen{1};
+        expectSameAsGenerated(HyperCubeTopology{n}, generateHyperCubeGraph(n, 1.0f, random_gen));
+    }
+}
+
+TEST(ImplicitGraphTest, CompleteLinksEveryPair) {
+    for (std::uint32_t n : {1, 2, 5}) {
+        ImplicitGraph<CompleteTopology> graph{CompleteTopology{n}};
+        for (std::uint32_t v = 0; v < n; ++v) {
+            std::vector<std::uint32_t> expected;
+            for (std::uint32_t u = 0; u < n; ++u) {
+                if (u != v) {
+                    expected.push_back(u);
+                }
+            }
+            ASSERT_EQ(sortedNeighbors(graph, v), expected);
+        }
+    }
+}
+
+// Neighbors differ by one in a single coordinate, or by k - 1 across the wrap-around
+TEST(ImplicitGraphTest, TorusLinksNeighborCoordinates) {
+    for (auto [arity, dimensions, wrap_around] : {std::tuple{3u, 2u, true}, std::tuple{4u, 2u, false}, std::tuple{5u, 3u, true}, std::tuple{2u, 3u, true}, std::tuple{1u, 2u, false}}) {
+        TorusTopology topology{arity, dimensions, wrap_around};
+        ImplicitGraph<TorusTopology> graph{topology};
+        for (std::uint32_t v = 0; v < graph.num_vertices(); ++v) {
+            std::vector<std::uint32_t> expected;
+            for (std::uint32_t u = 0; u < graph.num_vertices(); ++u) {
+                std::uint32_t differing = 0;
+                bool adjacent = false;
+                for (std::uint32_t a = v, b = u, i = 0; i < dimensions; a /= arity, b /= arity, ++i) {
+                    std::uint32_t distance = a % arity > b % arity ? a % arity - b % arity : b % arity - a % arity;
+                    differing += distance != 0;
+                    adjacent |= distance == 1 || (wrap_around && distance == arity - 1);
+                }
+                if (differing == 1 && adjacent) {
+                    expected.push_back(u);
+                }
+            }
+            ASSERT_EQ(sortedNeighbors(graph, v), expected) << "vertex " << v << " of the " << arity << "-ary " << dimensions << "-dimensional torus";
+        }
+    }
+}
+
+TEST(ImplicitGraphTest, SkipsEmptySlots) {
+    ImplicitGraph<GappedTopology> graph{GappedTopology{}};
+    auto [begin, end] = graph.adjacency(0);
+    ASSERT_EQ(std::vector<std::uint32_t>(begin, end), (std::vector<std::uint32_t>{2}));
+    auto [empty_begin, empty_end] = graph.adjacency(1);
+    ASSERT_TRUE(empty_begin == empty_end);
+    auto [last_begin, last_end] = graph.adjacency(2);
+    ASSERT_EQ(std::distance(last_begin, last_end), 1);
+    ASSERT_EQ(*last_begin, 0);
+}
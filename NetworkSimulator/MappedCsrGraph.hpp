@@ -0,0 +1,398 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "Node.hpp"
+#include "CsrGraph.hpp"
+
+// On-disk CSR layout, every section starts on a 64-byte boundary:
+//   CsrFileHeader
+//   offsets    std::uint64_t[num_vertices + 1]
+//   neighbors  std::uint32_t[num_neighbors], sorted per vertex, each undirected edge in both directions
+//   ids        std::uint32_t[num_vertices]    (if has_node_metadata)
+//   initiators std::uint8_t[num_vertices]     (if has_node_metadata)
+// All integers are little-endian, which is what the mapped graph reads them as.
+struct CsrFileHeader
+{
+    static constexpr char magic_value[8] = {'N', 'S', 'I', 'M', 'C', 'S', 'R', '\0'};
+    static constexpr std::uint32_t current_version = 1;
+    static constexpr std::uint32_t has_node_metadata = 1;
+
+    char _magic[8];
+    std::uint32_t _version;
+    std::uint32_t _flags;
+    std::uint64_t _num_vertices;
+    std::uint64_t _num_neighbors;
+    std::uint64_t _offsets_position;
+    std::uint64_t _neighbors_position;
+    std::uint64_t _ids_position;
+    std::uint64_t _initiators_position;
+};
+
+// Expected use of a mapped graph, passed on to the kernel with madvise
+enum class MappedAccess
+{
+    // Whole-graph scans, e.g. the diameter: aggressive read-ahead, pages dropped behind
+    Sequential,
+    // Event-driven simulation: only the pages that are touched
+    Random,
+    // Read the whole file in ahead of time
+    WillNeed,
+};
+
+namespace detail
+{
+inline std::uint64_t alignSection(std::uint64_t position)
+{
+    return (position + 63) / 64 * 64;
+}
+
+inline void writePadding(std::ofstream &out, std::uint64_t position)
+{
+    static const char zeros[64] = {};
+    std::uint64_t padding = alignSection(position) - position;
+    out.write(zeros, padding);
+}
+
+// Whether count elements of element_size bytes starting at position fit in a file of file_size bytes,
+// without overflowing on the corrupt positions and counts of a damaged header
+inline bool sectionFits(std::uint64_t position, std::uint64_t count, std::uint64_t element_size, std::uint64_t file_size)
+{
+    return position <= file_size && count <= (file_size - position) / element_size && position % element_size == 0;
+}
+}
+
+// Read-only mapping of a whole file
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &path)
+    {
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            throw std::runtime_error("Cannot open " + path + ".");
+        }
+
+        struct stat status;
+        if (::fstat(file, &status) != 0)
+        {
+            ::close(file);
+            throw std::runtime_error("Cannot read the size of " + path + ".");
+        }
+        _size = status.st_size;
+
+        // mmap rejects empty mappings, an empty file is just an empty range
+        if (_size > 0)
+        {
+            void *mapping = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, file, 0);
+            if (mapping == MAP_FAILED)
+            {
+                ::close(file);
+                throw std::runtime_error("Cannot map " + path + ".");
+            }
+            _data = static_cast<const std::uint8_t *>(mapping);
+        }
+        ::close(file);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept : _data{std::exchange(other._data, nullptr)}, _size{std::exchange(other._size, 0)} {}
+
+    ~MappedFile()
+    {
+        if (_data != nullptr)
+        {
+            ::munmap(const_cast<std::uint8_t *>(_data), _size);
+        }
+    }
+
+    const std::uint8_t *data() const { return _data; }
+    const char *chars() const { return reinterpret_cast<const char *>(_data); }
+    std::uint64_t size() const { return _size; }
+
+    void advise(MappedAccess access) const
+    {
+        if (_data == nullptr)
+        {
+            return;
+        }
+        int advice = access == MappedAccess::Sequential ? MADV_SEQUENTIAL : access == MappedAccess::Random ? MADV_RANDOM
+                                                                                                           : MADV_WILLNEED;
+        ::madvise(const_cast<std::uint8_t *>(_data), _size, advice);
+    }
+
+private:
+    const std::uint8_t *_data = nullptr;
+    std::uint64_t _size = 0;
+};
+
+// True if path starts with the magic of writeCsrFile
+inline bool isCsrFile(const std::string &path)
+{
+    std::ifstream in{path, std::ios::binary};
+    char magic[sizeof(CsrFileHeader::magic_value)] = {};
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, CsrFileHeader::magic_value, sizeof(magic)) == 0;
+}
+
+// Writes g in the on-disk CSR layout. Works with any graph whose vertices are
+// indices in [0, num_vertices), e.g. Graph or CsrGraph. Node ids and initiators are
+// saved with the topology if with_node_metadata is set.
+template <typename GraphType>
+void writeCsrFile(const std::string &path, const GraphType &g, bool with_node_metadata = true)
+{
+    const std::uint64_t n = num_vertices(g);
+
+    std::vector<std::uint64_t> offsets(n + 1, 0);
+    for (std::uint32_t v = 0; v < n; ++v)
+    {
+        auto [begin, end] = adjacent_vertices(v, g);
+        offsets[v + 1] = offsets[v] + std::distance(begin, end);
+    }
+
+    CsrFileHeader header{};
+    std::memcpy(header._magic, CsrFileHeader::magic_value, sizeof(header._magic));
+    header._version = CsrFileHeader::current_version;
+    header._flags = with_node_metadata ? CsrFileHeader::has_node_metadata : 0;
+    header._num_vertices = n;
+    header._num_neighbors = offsets.back();
+    header._offsets_position = detail::alignSection(sizeof(CsrFileHeader));
+    header._neighbors_position = detail::alignSection(header._offsets_position + (n + 1) * sizeof(std::uint64_t));
+    std::uint64_t end_of_neighbors = header._neighbors_position + header._num_neighbors * sizeof(std::uint32_t);
+    header._ids_position = with_node_metadata ? detail::alignSection(end_of_neighbors) : 0;
+    header._initiators_position = with_node_metadata ? detail::alignSection(header._ids_position + n * sizeof(std::uint32_t)) : 0;
+
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    if (!out)
+    {
+        throw std::runtime_error("Cannot open " + path + " for writing.");
+    }
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    detail::writePadding(out, sizeof(header));
+    out.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+    detail::writePadding(out, header._offsets_position + offsets.size() * sizeof(std::uint64_t));
+
+    std::vector<std::uint32_t> neighbors;
+    for (std::uint32_t v = 0; v < n; ++v)
+    {
+        auto [begin, end] = adjacent_vertices(v, g);
+        neighbors.assign(begin, end);
+        std::sort(neighbors.begin(), neighbors.end());
+        out.write(reinterpret_cast<const char *>(neighbors.data()), neighbors.size() * sizeof(std::uint32_t));
+    }
+
+    if (with_node_metadata)
+    {
+        detail::writePadding(out, end_of_neighbors);
+        std::vector<std::uint32_t> ids(n);
+        std::vector<std::uint8_t> initiators(n);
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            ids[v] = g[v]._id;
+            initiators[v] = g[v]._initiator;
+        }
+        out.write(reinterpret_cast<const char *>(ids.data()), ids.size() * sizeof(std::uint32_t));
+        detail::writePadding(out, header._ids_position + n * sizeof(std::uint32_t));
+        out.write(reinterpret_cast<const char *>(initiators.data()), initiators.size());
+    }
+
+    if (!out)
+    {
+        throw std::runtime_error("Failed to write " + path + ".");
+    }
+}
+
+// CsrGraph whose topology stays in a read-only memory-mapped file written by writeCsrFile.
+// The OS pages offsets and neighbors in as they are traversed, so opening the file costs
+// O(num_vertices) for the node states regardless of the number of edges.
+// Node states live in memory since the simulation modifies them: they get the ids and
+// initiators saved in the file, or _id = _x = index if the file has no node metadata.
+// Opening checks that the offsets are monotone and the neighbors are vertices, which reads the whole
+// file once, check_topology = false skips that for files known to be sound and only checks the header.
+template <typename NodeType = Node>
+class MappedCsrGraph
+{
+public:
+    using vertex_descriptor = std::uint32_t;
+    using edge_descriptor = std::uint64_t;
+    using adjacency_iterator = const std::uint32_t *;
+    using vertex_iterator = boost::counting_iterator<std::uint32_t>;
+    using directed_category = boost::undirected_tag;
+    using edge_parallel_category = boost::disallow_parallel_edge_tag;
+    using traversal_category = AdjacencyTraversalTag;
+    using vertices_size_type = std::uint32_t;
+    using edges_size_type = std::uint64_t;
+    using degree_size_type = std::uint32_t;
+    using vertex_bundled = NodeType;
+
+    explicit MappedCsrGraph(const std::string &path, MappedAccess access = MappedAccess::Random, bool check_topology = true) : _file{path}
+    {
+        if (_file.size() < sizeof(CsrFileHeader))
+        {
+            throw std::runtime_error(path + " is too small to be a CSR file.");
+        }
+        read_header(path);
+        if (check_topology)
+        {
+            advise(MappedAccess::Sequential);
+            check_adjacency(path);
+        }
+        advise(access);
+    }
+
+    // Can be changed at any time, e.g. Sequential for the diameter then Random for the simulation
+    void advise(MappedAccess access) const
+    {
+        _file.advise(access);
+    }
+
+    std::uint32_t num_vertices() const { return _nodes.size(); }
+
+    // Number of undirected edges
+    std::uint64_t num_edges() const { return _num_neighbors / 2; }
+
+    std::uint32_t degree(std::uint32_t v) const { return _offsets[v + 1] - _offsets[v]; }
+
+    std::pair<adjacency_iterator, adjacency_iterator> adjacency(std::uint32_t v) const
+    {
+        return {_neighbors + _offsets[v], _neighbors + _offsets[v + 1]};
+    }
+
+    NodeType &operator[](std::uint32_t v) { return _nodes[v]; }
+    const NodeType &operator[](std::uint32_t v) const { return _nodes[v]; }
+    const NodeType *node_data() const { return _nodes.data(); }
+
+    // Size of the mapped file, which is what the topology occupies once fully paged in
+    std::uint64_t mapped_bytes() const { return _file.size(); }
+
+private:
+    void read_header(const std::string &path)
+    {
+        CsrFileHeader header;
+        std::memcpy(&header, _file.data(), sizeof(header));
+        if (std::memcmp(header._magic, CsrFileHeader::magic_value, sizeof(header._magic)) != 0)
+        {
+            throw std::runtime_error(path + " is not a CSR file.");
+        }
+        if (header._version != CsrFileHeader::current_version)
+        {
+            throw std::runtime_error(path + " has unsupported CSR file version " + std::to_string(header._version) + ".");
+        }
+
+        const std::uint64_t n = header._num_vertices;
+        const bool has_node_metadata = (header._flags & CsrFileHeader::has_node_metadata) != 0;
+        if (n >= std::numeric_limits<std::uint32_t>::max() ||
+            !detail::sectionFits(header._offsets_position, n + 1, sizeof(std::uint64_t), _file.size()) ||
+            !detail::sectionFits(header._neighbors_position, header._num_neighbors, sizeof(std::uint32_t), _file.size()) ||
+            (has_node_metadata && (!detail::sectionFits(header._ids_position, n, sizeof(std::uint32_t), _file.size()) ||
+                                   !detail::sectionFits(header._initiators_position, n, sizeof(std::uint8_t), _file.size()))))
+        {
+            throw std::runtime_error(path + " is truncated or has a corrupt header.");
+        }
+
+        _offsets = reinterpret_cast<const std::uint64_t *>(_file.data() + header._offsets_position);
+        _neighbors = reinterpret_cast<const std::uint32_t *>(_file.data() + header._neighbors_position);
+        _num_neighbors = header._num_neighbors;
+        if (_offsets[0] != 0 || _offsets[n] != _num_neighbors)
+        {
+            throw std::runtime_error(path + " has offsets that don't match its neighbors.");
+        }
+
+        _nodes.resize(n);
+        const std::uint32_t *ids = has_node_metadata ? reinterpret_cast<const std::uint32_t *>(_file.data() + header._ids_position) : nullptr;
+        const std::uint8_t *initiators = has_node_metadata ? _file.data() + header._initiators_position : nullptr;
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            _nodes[v]._id = has_node_metadata ? ids[v] : v;
+            _nodes[v]._x = _nodes[v]._id;
+            _nodes[v]._initiator = has_node_metadata && initiators[v] != 0;
+        }
+    }
+
+    // O(n + m), so that a corrupt file fails here instead of reading out of bounds during the run
+    void check_adjacency(const std::string &path) const
+    {
+        const std::uint32_t n = _nodes.size();
+        for (std::uint32_t v = 0; v < n; ++v)
+        {
+            if (_offsets[v] > _offsets[v + 1])
+            {
+                throw std::runtime_error(path + " has decreasing offsets at vertex " + std::to_string(v) + ".");
+            }
+        }
+        if (std::any_of(_neighbors, _neighbors + _num_neighbors, [n](std::uint32_t neighbor)
+                        { return neighbor >= n; }))
+        {
+            throw std::runtime_error(path + " has neighbors that are not vertices.");
+        }
+    }
+
+    MappedFile _file;
+    const std::uint64_t *_offsets = nullptr;
+    const std::uint32_t *_neighbors = nullptr;
+    std::uint64_t _num_neighbors = 0;
+    std::vector<NodeType> _nodes{};
+};
+
+template <typename NodeType>
+std::pair<boost::counting_iterator<std::uint32_t>, boost::counting_iterator<std::uint32_t>> vertices(const MappedCsrGraph<NodeType> &g)
+{
+    return {0, g.num_vertices()};
+}
+
+template <typename NodeType>
+std::uint32_t num_vertices(const MappedCsrGraph<NodeType> &g)
+{
+    return g.num_vertices();
+}
+
+template <typename NodeType>
+std::uint64_t num_edges(const MappedCsrGraph<NodeType> &g)
+{
+    return g.num_edges();
+}
+
+template <typename NodeType>
+std::pair<const std::uint32_t *, const std::uint32_t *> adjacent_vertices(std::uint32_t v, const MappedCsrGraph<NodeType> &g)
+{
+    return g.adjacency(v);
+}
+
+template <typename NodeType>
+std::uint32_t out_degree(std::uint32_t v, const MappedCsrGraph<NodeType> &g)
+{
+    return g.degree(v);
+}
+
+template <typename NodeType, typename Member, typename T>
+NodeMemberMap<NodeType, T> get(T Member::*member, const MappedCsrGraph<NodeType> &g)
+{
+    return {g.node_data(), member};
+}
+
+template <typename NodeType>
+void prefetchAdjacency(std::uint32_t v, const MappedCsrGraph<NodeType> &g)
+{
+    prefetch(g.adjacency(v).first);
+}
@@ -0,0 +1,64 @@
+#include "MappedCsrGraph.hpp"
+
+#include "GraphGen.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+class MappedCsrGraphTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        _path = ::testing::TempDir() + "mapped_csr_graph_test.csr";
+        writeCsrFile(_path, generateRingGraph(10));
+    }
+
+    void TearDown() override {
+        std::remove(_path.c_str());
+    }
+
+    // Overwrites the file at position with the bytes of value
+    template <typename T>
+    void patch(std::uint64_t position, T value) {
+        std::fstream file{_path, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(position);
+        file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    CsrFileHeader header() {
+        CsrFileHeader header;
+        std::ifstream file{_path, std::ios::binary};
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        return header;
+    }
+
+    std::string _path;
+};
+
+TEST_F(MappedCsrGraphTest, ReadsBackTheWrittenGraph) {
+    MappedCsrGraph<> graph{_path};
+    ASSERT_EQ(graph.num_vertices(), 10);
+    ASSERT_EQ(graph.num_edges(), 10);
+    auto [begin, end] = graph.adjacency(0);
+    ASSERT_EQ(std::vector<std::uint32_t>(begin, end), (std::vector<std::uint32_t>{1, 9}));
+}
+
+// 2^62 neighbors take 2^64 bytes, which wraps around to 0 when computed naively
+TEST_F(MappedCsrGraphTest, RejectsOverflowingNeighborCount) {
+    patch(offsetof(CsrFileHeader, _num_neighbors), std::uint64_t{1} << 62);
+    patch(header()._offsets_position + 10 * sizeof(std::uint64_t), std::uint64_t{1} << 62);
+    ASSERT_THROW(MappedCsrGraph<>{_path}, std::runtime_error);
+}
+
+TEST_F(MappedCsrGraphTest, RejectsDecreasingOffsets) {
+    patch(header()._offsets_position + 3 * sizeof(std::uint64_t), std::uint64_t{1});
+    ASSERT_THROW(MappedCsrGraph<>{_path}, std::runtime_error);
+}
+
+TEST_F(MappedCsrGraphTest, RejectsNeighborsOutOfRange) {
+    patch(header()._neighbors_position + 5 * sizeof(std::uint32_t), std::uint32_t{10});
+    ASSERT_THROW(MappedCsrGraph<>{_path}, std::runtime_error);
+    // Only the header is checked when the topology check is skipped
+    ASSERT_NO_THROW((MappedCsrGraph<>{_path, MappedAccess::Random, false}));
+}
@@ -54,8 +54,9 @@ public:
             broadcast(id_map, adjacent_begin, adjacent_end, message_sender);
         }
 
+        // A node left without neighbors by a topology change has no pulse to run
         bool stopping_condition = false;
-        if (all_messages_received(id_map, adjacent_begin, adjacent_end))
+        if (_awake && adjacent_begin != adjacent_end && all_messages_received(id_map, adjacent_begin, adjacent_end))
         {
             stopping_condition = run_pulse(id_map, adjacent_begin, adjacent_end, message_sender);
         }
@@ -74,6 +75,24 @@ public:
         }
     }
 
+    // Called by the engine when a link to neighbor_id appears. The new neighbor gets this node's
+    // current state, which counts as this node's message for the pulse the neighbor is waiting on,
+    // or the completion signal if this node has already terminated.
+    template <typename MessageSender>
+    void neighbor_added(std::uint32_t neighbor_id, const MessageSender &message_sender) const
+    {
+        if (_awake)
+        {
+            message_sender(neighbor_id, Message{_x, _d});
+        }
+    }
+
+    // Called by the engine when the link to neighbor_id disappears, its undelivered messages are dropped
+    void neighbor_removed(std::uint32_t neighbor_id)
+    {
+        _incoming_messages.erase(neighbor_id);
+    }
+
 private:
     template <typename PropertyMap, typename Iterator, typename MessageSender>
     bool run_pulse(const PropertyMap &id_map, const Iterator &adjacent_begin, const Iterator &adjacent_end, const MessageSender &message_sender)
@@ -186,4 +205,19 @@ private:
     }
 };
 
-using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, Node, boost::no_property>;
\ No newline at end of file
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, Node, boost::no_property>;
+
+// Hint the CPU that the cache line at address will be written soon
+inline void prefetch(const void *address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 1, 3);
+#endif
+}
+
+// Prefetches the start of the out-edge storage of vertex v
+template <typename VertexProperty>
+void prefetchAdjacency(std::size_t v, const boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, VertexProperty, boost::no_property> &g)
+{
+    prefetch(g.out_edge_list(v).data());
+}
\ No newline at end of file
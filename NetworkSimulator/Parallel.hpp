@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Number of worker threads used when the caller passes 0
+inline std::uint32_t defaultThreadCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Splits [begin, end) into one contiguous range per thread and calls
+// body(thread, range_begin, range_end) for each of them, the calling thread takes range 0.
+// Ranges only depend on (begin, end, num_threads), so a body that writes
+// per-range results can combine them in a deterministic order.
+template <typename Body>
+void parallelFor(std::uint64_t begin, std::uint64_t end, std::uint32_t num_threads, const Body &body)
+{
+    if (num_threads == 0)
+    {
+        num_threads = defaultThreadCount();
+    }
+    const std::uint64_t count = end > begin ? end - begin : 0;
+    num_threads = static_cast<std::uint32_t>(std::clamp<std::uint64_t>(count, 1, num_threads));
+
+    auto range_begin = [&](std::uint32_t thread)
+    {
+        return begin + count * thread / num_threads;
+    };
+
+    std::vector<std::jthread> workers;
+    workers.reserve(num_threads - 1);
+    for (std::uint32_t thread = 1; thread < num_threads; ++thread)
+    {
+        workers.emplace_back([&, thread]
+                             { body(thread, range_begin(thread), range_begin(thread + 1)); });
+    }
+    body(0, range_begin(0), range_begin(1));
+}
+
+// In-place exclusive prefix sum of values, values.back() ends up holding the total
+// if the last entry was 0 on input (the usual CSR offsets layout).
+template <typename T>
+void parallelExclusiveScan(std::vector<T> &values, std::uint32_t num_threads)
+{
+    if (num_threads == 0)
+    {
+        num_threads = defaultThreadCount();
+    }
+    num_threads = static_cast<std::uint32_t>(std::clamp<std::uint64_t>(values.size() / 65536, 1, num_threads));
+
+    std::vector<T> block_sums(num_threads + 1, 0);
+    parallelFor(0, values.size(), num_threads, [&](std::uint32_t thread, std::uint64_t begin, std::uint64_t end)
+                {
+                    T sum = 0;
+                    for (std::uint64_t i = begin; i < end; ++i)
+                    {
+                        sum += values[i];
+                    }
+                    block_sums[thread + 1] = sum; });
+
+    for (std::uint32_t thread = 0; thread < num_threads; ++thread)
+    {
+        block_sums[thread + 1] += block_sums[thread];
+    }
+
+    parallelFor(0, values.size(), num_threads, [&](std::uint32_t thread, std::uint64_t begin, std::uint64_t end)
+                {
+                    T sum = block_sums[thread];
+                    for (std::uint64_t i = begin; i < end; ++i)
+                    {
+                        T value = values[i];
+                        values[i] = sum;
+                        sum += value;
+                    } });
+}
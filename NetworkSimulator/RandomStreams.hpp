@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+// Finalizer of SplitMix64, a bijective 64-bit mix
+inline std::uint64_t mixBits(std::uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Seed of the stream identified by (seed, a, b), streams with different ids are independent
+inline std::uint64_t streamSeed(std::uint64_t seed, std::uint64_t a, std::uint64_t b = 0)
+{
+    return mixBits(mixBits(seed ^ mixBits(a + 0x9e3779b97f4a7c15ULL)) ^ mixBits(b + 0x632be59bd9b4e019ULL));
+}
+
+// SplitMix64, a tiny generator that is cheap to seed, which makes it suitable for
+// deriving one stream per vertex, tile or chunk from (seed, stream id).
+// Satisfies UniformRandomBitGenerator so it works with the <random> distributions.
+class SplitMix64
+{
+public:
+    using result_type = std::uint64_t;
+
+    explicit SplitMix64(std::uint64_t seed) : _state{seed} {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        _state += 0x9e3779b97f4a7c15ULL;
+        return mixBits(_state);
+    }
+
+    // Uniform double in [0, 1)
+    double uniform()
+    {
+        return ((*this)() >> 11) * 0x1.0p-53;
+    }
+
+private:
+    std::uint64_t _state;
+};
+
+// Number of failures before the next success in a sequence of Bernoulli(p) trials,
+// with log_q = log(1 - p). Used to jump straight to the next edge when sampling G(n, p).
+template <typename RandomEngine>
+std::uint64_t geometricSkip(RandomEngine &random_gen, double log_q)
+{
+    double u = std::uniform_real_distribution<double>{0.0, 1.0}(random_gen);
+    double skip = std::floor(std::log1p(-u) / log_q);
+    if (!(skip >= 0.0 && skip < 0x1.0p62))
+    {
+        // p = 0 or a skip past any graph we could store
+        return std::numeric_limits<std::uint64_t>::max() / 2;
+    }
+    return static_cast<std::uint64_t>(skip);
+}
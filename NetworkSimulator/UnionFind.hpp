@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// Disjoint sets over [0, size) with union by size and path halving, so a sequence of m
+// operations takes O(m α(n)). Keeps the number of sets, e.g. to tell whether a graph whose
+// edges are unite()d one by one is connected yet.
+class UnionFind
+{
+public:
+    explicit UnionFind(std::uint32_t size = 0)
+        : _parents(size), _sizes(size, 1), _num_sets{size}
+    {
+        std::iota(_parents.begin(), _parents.end(), 0);
+    }
+
+    std::uint32_t size() const { return _parents.size(); }
+    std::uint32_t num_sets() const { return _num_sets; }
+
+    std::uint32_t find(std::uint32_t v)
+    {
+        while (_parents[v] != v)
+        {
+            _parents[v] = _parents[_parents[v]];
+            v = _parents[v];
+        }
+        return v;
+    }
+
+    // Returns false if u and v were already in the same set
+    bool unite(std::uint32_t u, std::uint32_t v)
+    {
+        u = find(u);
+        v = find(v);
+        if (u == v)
+        {
+            return false;
+        }
+        if (_sizes[u] < _sizes[v])
+        {
+            std::swap(u, v);
+        }
+        _parents[v] = u;
+        _sizes[u] += _sizes[v];
+        --_num_sets;
+        return true;
+    }
+
+    std::uint32_t set_size(std::uint32_t v) { return _sizes[find(v)]; }
+
+private:
+    std::vector<std::uint32_t> _parents;
+    std::vector<std::uint32_t> _sizes;
+    std::uint32_t _num_sets;
+};
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CsrGraph.hpp"
+
+// Layouts that put vertices that are used together close in memory.
+// Only the storage order changes: node ids (_id, _x) travel with their node, so
+// the simulation elects the same leader and the engine finds nodes through their ids.
+enum class VertexOrdering
+{
+    // Reverse Cuthill-McKee: BFS from a low degree vertex, neighbors by increasing degree, reversed
+    CuthillMcKee,
+    // Decreasing degree, hubs share the first cache lines
+    DegreeSorted,
+    // Greedy Gorder: the next vertex is the one sharing the most neighbors and edges
+    // with the last few placed vertices
+    Gorder,
+};
+
+inline VertexOrdering parseVertexOrdering(const std::string &name)
+{
+    if (name == "rcm")
+        return VertexOrdering::CuthillMcKee;
+    if (name == "degree")
+        return VertexOrdering::DegreeSorted;
+    if (name == "gorder")
+        return VertexOrdering::Gorder;
+    throw std::runtime_error("Unknown vertex ordering : " + name);
+}
+
+namespace detail
+{
+template <typename GraphType>
+std::vector<std::uint32_t> cuthillMcKeeOrder(const GraphType &g)
+{
+    const std::uint32_t n = num_vertices(g);
+    auto degree = [&g](std::uint32_t v)
+    {
+        auto [begin, end] = adjacent_vertices(v, g);
+        return static_cast<std::uint32_t>(std::distance(begin, end));
+    };
+
+    // Each component starts from its lowest degree vertex
+    std::vector<std::uint32_t> by_degree(n);
+    std::iota(by_degree.begin(), by_degree.end(), 0);
+    std::stable_sort(by_degree.begin(), by_degree.end(), [&](auto a, auto b)
+                     { return degree(a) < degree(b); });
+
+    std::vector<std::uint32_t> order;
+    order.reserve(n);
+    std::vector<bool> visited(n, false);
+    std::vector<std::uint32_t> neighbors;
+
+    for (std::uint32_t start : by_degree)
+    {
+        if (visited[start])
+        {
+            continue;
+        }
+
+        visited[start] = true;
+        std::size_t head = order.size();
+        order.push_back(start);
+
+        // order doubles as the BFS queue
+        while (head < order.size())
+        {
+            std::uint32_t v = order[head++];
+
+            neighbors.clear();
+            auto [begin, end] = adjacent_vertices(v, g);
+            for (auto it = begin; it != end; ++it)
+            {
+                if (!visited[*it])
+                {
+                    visited[*it] = true;
+                    neighbors.push_back(*it);
+                }
+            }
+            std::stable_sort(neighbors.begin(), neighbors.end(), [&](auto a, auto b)
+                             { return degree(a) < degree(b); });
+            order.insert(order.end(), neighbors.begin(), neighbors.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+template <typename GraphType>
+std::vector<std::uint32_t> degreeSortedOrder(const GraphType &g)
+{
+    const std::uint32_t n = num_vertices(g);
+    std::vector<std::uint32_t> degrees(n);
+    for (std::uint32_t v = 0; v < n; ++v)
+    {
+        auto [begin, end] = adjacent_vertices(v, g);
+        degrees[v] = std::distance(begin, end);
+    }
+
+    std::vector<std::uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](auto a, auto b)
+                     { return degrees[a] > degrees[b]; });
+    return order;
+}
+
+// Score of v = number of placed vertices in the window that are adjacent to v or share a neighbor with v.
+// Scores are updated when vertices enter and leave the window, the max-heap is lazy:
+// stale entries are re-pushed with the current score when popped.
+template <typename GraphType>
+std::vector<std::uint32_t> gorderOrder(const GraphType &g, std::uint32_t window, std::uint32_t hub_degree)
+{
+    const std::uint32_t n = num_vertices(g);
+    std::vector<std::int64_t> scores(n, 0);
+    std::vector<bool> placed(n, false);
+    std::priority_queue<std::pair<std::int64_t, std::uint32_t>> heap;
+
+    auto update = [&](std::uint32_t v, std::int64_t delta)
+    {
+        auto bump = [&](std::uint32_t u)
+        {
+            if (!placed[u])
+            {
+                scores[u] += delta;
+                if (delta > 0)
+                {
+                    heap.emplace(scores[u], u);
+                }
+            }
+        };
+
+        auto [begin, end] = adjacent_vertices(v, g);
+        for (auto it = begin; it != end; ++it)
+        {
+            bump(*it);
+
+            // Siblings through a hub are everyone, they don't say anything about locality
+            auto [sibling_begin, sibling_end] = adjacent_vertices(*it, g);
+            if (static_cast<std::uint32_t>(std::distance(sibling_begin, sibling_end)) > hub_degree)
+            {
+                continue;
+            }
+            for (auto sibling = sibling_begin; sibling != sibling_end; ++sibling)
+            {
+                if (*sibling != v)
+                {
+                    bump(*sibling);
+                }
+            }
+        }
+    };
+
+    std::vector<std::uint32_t> by_degree = degreeSortedOrder(g);
+    std::size_t next_unplaced = 0;
+
+    std::vector<std::uint32_t> order;
+    order.reserve(n);
+    while (order.size() < n)
+    {
+        std::optional<std::uint32_t> next;
+        while (!heap.empty() && !next.has_value())
+        {
+            auto [score, v] = heap.top();
+            heap.pop();
+            if (placed[v] || scores[v] <= 0)
+            {
+                continue;
+            }
+            if (score != scores[v])
+            {
+                heap.emplace(scores[v], v);
+                continue;
+            }
+            next = v;
+        }
+
+        if (!next.has_value())
+        {
+            // Nothing related to the window, continue with the highest degree vertex left
+            while (placed[by_degree[next_unplaced]])
+            {
+                ++next_unplaced;
+            }
+            next = by_degree[next_unplaced];
+        }
+
+        placed[*next] = true;
+        order.push_back(*next);
+        update(*next, 1);
+        if (order.size() > window)
+        {
+            update(order[order.size() - window - 1], -1);
+        }
+    }
+
+    return order;
+}
+}
+
+// Returns the new layout as order[new index] = old index
+template <typename GraphType>
+std::vector<std::uint32_t> computeVertexOrder(const GraphType &g, VertexOrdering ordering)
+{
+    switch (ordering)
+    {
+    case VertexOrdering::CuthillMcKee:
+        return detail::cuthillMcKeeOrder(g);
+    case VertexOrdering::DegreeSorted:
+        return detail::degreeSortedOrder(g);
+    case VertexOrdering::Gorder:
+        return detail::gorderOrder(g, 5, 256);
+    }
+    throw std::runtime_error("Unknown vertex ordering.");
+}
+
+// Copy of g with vertex order[i] stored at index i. Node states are moved along unchanged.
+template <typename NodeType>
+CsrGraph<NodeType> reorderVertices(const CsrGraph<NodeType> &g, const std::vector<std::uint32_t> &order)
+{
+    const std::uint32_t n = g.num_vertices();
+    if (order.size() != n)
+    {
+        throw std::runtime_error("The order must contain every vertex once.");
+    }
+
+    std::vector<std::uint32_t> new_index(n);
+    for (std::uint32_t i = 0; i < n; ++i)
+    {
+        new_index[order[i]] = i;
+    }
+
+    std::vector<std::uint64_t> offsets(n + 1, 0);
+    std::vector<std::uint32_t> neighbors;
+    neighbors.reserve(2 * g.num_edges());
+    std::vector<NodeType> nodes;
+    nodes.reserve(n);
+
+    for (std::uint32_t i = 0; i < n; ++i)
+    {
+        auto [begin, end] = g.adjacency(order[i]);
+        for (auto it = begin; it != end; ++it)
+        {
+            neighbors.push_back(new_index[*it]);
+        }
+        std::sort(neighbors.begin() + offsets[i], neighbors.end());
+        offsets[i + 1] = neighbors.size();
+        nodes.push_back(g[order[i]]);
+    }
+
+    return CsrGraph<NodeType>{std::move(offsets), std::move(neighbors), std::move(nodes)};
+}
+
+template <typename NodeType>
+CsrGraph<NodeType> reorderVertices(const CsrGraph<NodeType> &g, VertexOrdering ordering)
+{
+    return reorderVertices(g, computeVertexOrder(g, ordering));
+}
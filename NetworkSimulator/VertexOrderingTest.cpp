@@ -0,0 +1,105 @@
+#include "VertexOrdering.hpp"
+
+#include "GraphGen.hpp"
+#include "ImplicitGraph.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr VertexOrdering all_orderings[] = {VertexOrdering::CuthillMcKee, VertexOrdering::DegreeSorted, VertexOrdering::Gorder};
+
+// Largest |new index of u - new index of v| over the edges
+template <typename NodeType>
+std::uint32_t bandwidth(const CsrGraph<NodeType> &graph) {
+    std::uint32_t width = 0;
+    for (std::uint32_t v = 0; v < graph.num_vertices(); ++v) {
+        auto [begin, end] = graph.adjacency(v);
+        for (auto it = begin; it != end; ++it) {
+            width = std::max(width, v > *it ? v - *it : *it - v);
+        }
+    }
+    return width;
+}
+
+// The graph with its vertices stored in a random order
+template <typename NodeType>
+CsrGraph<NodeType> shuffled(const CsrGraph<NodeType> &graph, std::uint32_t seed) {
+    std::vector<std::uint32_t> order(graph.num_vertices());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::default_random_engine{seed});
+    return reorderVertices(graph, order);
+}
+
+// order is a permutation, and vertex i of the reordered graph is vertex order[i] of graph with the same
+// neighbors mapped through order and the same node state
+void expectRelabeledCopy(const CsrGraph<> &graph, const std::vector<std::uint32_t> &order, const CsrGraph<> &reordered) {
+    std::vector<std::uint32_t> sorted_order = order;
+    std::sort(sorted_order.begin(), sorted_order.end());
+    std::vector<std::uint32_t> identity(graph.num_vertices());
+    std::iota(identity.begin(), identity.end(), 0);
+    ASSERT_EQ(sorted_order, identity);
+
+    ASSERT_EQ(reordered.num_vertices(), graph.num_vertices());
+    ASSERT_EQ(reordered.num_edges(), graph.num_edges());
+    for (std::uint32_t i = 0; i < graph.num_vertices(); ++i) {
+        auto [begin, end] = reordered.adjacency(i);
+        ASSERT_TRUE(std::is_sorted(begin, end));
+        std::vector<std::uint32_t> mapped_back;
+        for (auto it = begin; it != end; ++it) {
+            mapped_back.push_back(order[*it]);
+        }
+        std::sort(mapped_back.begin(), mapped_back.end());
+        auto [original_begin, original_end] = graph.adjacency(order[i]);
+        ASSERT_EQ(mapped_back, std::vector<std::uint32_t>(original_begin, original_end)) << "vertex " << order[i];
+        ASSERT_EQ(reordered[i]._id, graph[order[i]]._id);
+        ASSERT_EQ(reordered[i]._x, graph[order[i]]._x);
+        ASSERT_EQ(reordered[i]._initiator, graph[order[i]]._initiator);
+    }
+}
+
+}
+
+// A random graph, a scale-free graph with hubs, and a graph with several components and isolated vertices
+TEST(VertexOrderingTest, ReordersIntoARelabeledCopy) {
+    std::default_random_engine random_gen{3};
+    std::vector<CsrGraph<>> graphs{CsrGraph<>{generateRandomGraph(300, 0.1f, 0.02f, random_gen)},
+                                   CsrGraph<>{generateScaleFreeGraph(300, 2, 0.1f, random_gen)},
+                                   CsrGraph<>{40, {{0, 5}, {5, 9}, {12, 30}, {30, 31}, {31, 12}, {20, 39}}}};
+    for (const auto &graph : graphs) {
+        for (VertexOrdering ordering : all_orderings) {
+            std::vector<std::uint32_t> order = computeVertexOrder(graph, ordering);
+            expectRelabeledCopy(graph, order, reorderVertices(graph, ordering));
+        }
+    }
+}
+
+TEST(VertexOrderingTest, DegreeSortedPutsHubsFirst) {
+    std::default_random_engine random_gen{4};
+    CsrGraph<> graph = reorderVertices(CsrGraph<>{generateScaleFreeGraph(500, 2, 0.1f, random_gen)}, VertexOrdering::DegreeSorted);
+    for (std::uint32_t v = 1; v < graph.num_vertices(); ++v) {
+        ASSERT_GE(graph.degree(v - 1), graph.degree(v));
+    }
+}
+
+// Cuthill-McKee recovers a narrow band from a random layout of a ring or a grid
+TEST(VertexOrderingTest, CuthillMcKeeReducesTheBandwidth) {
+    CsrGraph<> ring = shuffled(CsrGraph<>{generateRingGraph(200)}, 1);
+    CsrGraph<> ring_rcm = reorderVertices(ring, VertexOrdering::CuthillMcKee);
+    ASSERT_LE(bandwidth(ring_rcm), 2);
+    ASSERT_LE(bandwidth(ring_rcm), bandwidth(ring));
+
+    CsrGraph<> grid = shuffled(CsrGraph<>{ImplicitGraph<TorusTopology>{TorusTopology{20, 2, false}}}, 2);
+    CsrGraph<> grid_rcm = reorderVertices(grid, VertexOrdering::CuthillMcKee);
+    ASSERT_LE(bandwidth(grid_rcm), 2 * 20);
+    ASSERT_LE(bandwidth(grid_rcm), bandwidth(grid));
+}
+
+TEST(VertexOrderingTest, RejectsOrdersOfTheWrongSize) {
+    ASSERT_THROW(reorderVertices(CsrGraph<>{generateRingGraph(5)}, std::vector<std::uint32_t>{0, 1, 2}), std::runtime_error);
+    ASSERT_THROW(parseVertexOrdering("random"), std::runtime_error);
+}